@@ -0,0 +1,3 @@
+#!/bin/sh
+# Usage: ./bench.sh <benchmark> [options]   e.g. ./bench.sh render --baseline bench/baseline_render.txt
+.pio/build/bench_native/program "$@"
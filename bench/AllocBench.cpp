@@ -0,0 +1,152 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "PoolAllocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+//
+// Allocation churn shaped like LVGL's heap traffic: mostly small objects (styles, event descriptors,
+// object attributes), some label text and draw buffers, the odd snapshot-sized block. Random slots of a
+// fixed live set are freed and re-allocated, and every call is timed on its own so the tails show.
+// The same seeded sequence runs against malloc/free and against poolAlloc/poolFree.
+//
+
+static const uint32_t liveSlots = 1500;
+
+struct Latencies {
+    std::vector<uint32_t> alloc;
+    std::vector<uint32_t> free;
+    uint32_t failures = 0;
+};
+
+static uint32_t nextRand(uint32_t& seed) {
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+static size_t nextSize(uint32_t& seed) {
+    uint32_t r = nextRand(seed) % 100;
+    if (r < 60) return 8 + nextRand(seed) % 57;         // 8..64
+    if (r < 85) return 65 + nextRand(seed) % 192;       // 65..256
+    if (r < 97) return 257 + nextRand(seed) % 1792;     // 257..2048
+    return 2049 + nextRand(seed) % 6144;                // 2049..8192
+}
+
+// Returns the live set at the end, still allocated.
+template <typename Alloc, typename Free>
+static std::vector<void*> churn(uint32_t ops, Alloc doAlloc, Free doFree, Latencies& lat) {
+    std::vector<void*> live(liveSlots, nullptr);
+    uint32_t seed = 12345;
+    lat.alloc.reserve(ops);
+    lat.free.reserve(ops);
+
+    for (uint32_t i = 0; i < ops; i++) {
+        void*& slot = live[nextRand(seed) % liveSlots];
+        if (slot) {
+            uint64_t start = benchNowNS();
+            doFree(slot);
+            lat.free.push_back((uint32_t)(benchNowNS() - start));
+            slot = nullptr;
+        }
+        else {
+            size_t size = nextSize(seed);
+            uint64_t start = benchNowNS();
+            slot = doAlloc(size);
+            lat.alloc.push_back((uint32_t)(benchNowNS() - start));
+            if (slot)
+                *(volatile uint8_t*)slot = 1;   // touch it like a real user would
+            else
+                lat.failures++;
+        }
+    }
+
+    return live;
+}
+
+static double percentile(std::vector<uint32_t>& v, double pct) {
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)(pct / 100.0 * v.size() + 0.5);
+    return v[rank ? std::min(rank, v.size()) - 1 : 0];
+}
+
+static void printRow(const char* name, std::vector<uint32_t>& v) {
+    printf("  %-12s %8.0f %8.0f %8.0f %8.0f\n", name,
+           percentile(v, 50), percentile(v, 99), percentile(v, 99.9), percentile(v, 100));
+}
+
+int allocBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 500000;
+
+    Latencies libc, pool;
+    for (void* p : churn(opts.frames, [](size_t n) { return malloc(n); }, [](void* p) { free(p); }, libc))
+        free(p);
+
+    // Several rounds so fragmentation has a chance to build up, like weeks of screen switches would.
+    // The last round's live set stays allocated until the statistics are taken.
+    std::vector<void*> live;
+    for (int round = 0; round < 3; round++) {
+        for (void* p : live)
+            poolFree(p);
+        pool.alloc.clear();
+        pool.free.clear();
+        pool.failures = 0;
+        live = churn(opts.frames, poolAlloc, poolFree, pool);
+    }
+
+    printf("Latency (ns)       p50      p99    p99.9      max\n");
+    printRow("malloc", libc.alloc);
+    printRow("free", libc.free);
+    printRow("poolAlloc", pool.alloc);
+    printRow("poolFree", pool.free);
+    if (pool.failures)
+        printf("poolAlloc failed %u times - arena (POOL_ALLOC_ARENA_SIZE) too small for this live set.\n", pool.failures);
+
+    poolAllocPrintStats();
+    PoolAllocStats stats;
+    poolAllocGetStats(&stats);
+    for (void* p : live)
+        poolFree(p);
+
+    BenchMetrics metrics;
+    metrics.set("pool_alloc_p50_ns", percentile(pool.alloc, 50), false);
+    metrics.set("pool_alloc_p99_ns", percentile(pool.alloc, 99), false);
+    metrics.set("pool_free_p99_ns", percentile(pool.free, 99), false);
+    metrics.set("malloc_p99_ns", percentile(libc.alloc, 99), false);
+    metrics.set("fragmentation_pct", stats.fragmentationPct, false);
+    metrics.print("Allocator benchmark");
+
+    return opts.finish(metrics);
+}
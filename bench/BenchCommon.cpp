@@ -0,0 +1,261 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+static uint32_t flushedPixels = 0;
+
+static lv_coord_t pointerX = 0;
+static lv_coord_t pointerY = 0;
+static bool pointerPressed = false;
+
+uint64_t benchNowUS() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t benchNowNS() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void headlessFlush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p) {
+    flushedPixels += (uint32_t)lv_area_get_size(area);
+    lv_disp_flush_ready(disp);
+}
+
+static void scriptedPointerRead(lv_indev_drv_t* indev_driver, lv_indev_data_t* data) {
+    data->point.x = pointerX;
+    data->point.y = pointerY;
+    data->state = pointerPressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+}
+
+lv_disp_t* benchDisplayInit(uint16_t bufferDivider) {
+    static lv_disp_draw_buf_t display_buffer;
+    static lv_color_t* image_buffer = nullptr;
+    uint32_t bufPixels = SDL_HOR_RES * SDL_VER_RES / (bufferDivider ? bufferDivider : 1);
+
+    image_buffer = new lv_color_t[bufPixels];
+    lv_disp_draw_buf_init(&display_buffer, image_buffer, NULL, bufPixels);
+
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = SDL_HOR_RES;
+    disp_drv.ver_res = SDL_VER_RES;
+    disp_drv.flush_cb = headlessFlush;
+    disp_drv.draw_buf = &display_buffer;
+    lv_disp_t* disp = lv_disp_drv_register(&disp_drv);
+
+    static lv_indev_drv_t indev_drv;
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb = scriptedPointerRead;
+    lv_indev_drv_register(&indev_drv);
+
+    lv_theme_t * th = lv_theme_default_init(disp, lv_palette_main(LV_PALETTE_BLUE), lv_palette_main(LV_PALETTE_BLUE_GREY),
+                                                false, LV_FONT_DEFAULT);
+    lv_disp_set_theme(disp, th);
+
+    return disp;
+}
+
+uint32_t benchTakeFlushedPixels() {
+    uint32_t px = flushedPixels;
+    flushedPixels = 0;
+    return px;
+}
+
+void benchPointerSet(lv_coord_t x, lv_coord_t y, bool pressed) {
+    pointerX = x;
+    pointerY = y;
+    pointerPressed = pressed;
+}
+
+////////////////////////////////////////
+//
+//  F r a m e S t a t s
+//
+////////////////////////////////////////
+
+void FrameStats::add(double ms, uint32_t pixels) {
+    frameMS.push_back(ms);
+    totalPixels += pixels;
+}
+
+void FrameStats::clear() {
+    frameMS.clear();
+    totalPixels = 0;
+}
+
+double FrameStats::percentileMS(double pct) const {
+    if (frameMS.empty())
+        return 0.0;
+
+    std::vector<double> sorted(frameMS);
+    std::sort(sorted.begin(), sorted.end());
+    // Nearest-rank percentile
+    size_t rank = (size_t)std::ceil(pct / 100.0 * sorted.size());
+    return sorted[rank ? rank-1 : 0];
+}
+
+double FrameStats::totalMS() const {
+    double total = 0.0;
+    for (double ms : frameMS)
+        total += ms;
+    return total;
+}
+
+double FrameStats::fps() const {
+    double total = totalMS();
+    return total > 0.0 ? frameMS.size() * 1000.0 / total : 0.0;
+}
+
+double FrameStats::pixelsPerFrame() const {
+    return frameMS.empty() ? 0.0 : (double)totalPixels / frameMS.size();
+}
+
+////////////////////////////////////////
+//
+//  B e n c h M e t r i c s
+//
+////////////////////////////////////////
+
+void BenchMetrics::set(const char* name, double value, bool higherIsBetter) {
+    for (Metric& m : metrics) {
+        if (m.name == name) {
+            m.value = value;
+            m.higherIsBetter = higherIsBetter;
+            return;
+        }
+    }
+    metrics.push_back(Metric{name, value, higherIsBetter});
+}
+
+void BenchMetrics::print(const char* title) const {
+    printf("== %s ==\n", title);
+    for (const Metric& m : metrics)
+        printf("  %-24s %12.3f\n", m.name.c_str(), m.value);
+}
+
+bool BenchMetrics::save(const char* path) const {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        printf("Unable to write baseline file %s\n", path);
+        return false;
+    }
+
+    for (const Metric& m : metrics)
+        fprintf(fp, "%s %.6f\n", m.name.c_str(), m.value);
+
+    fclose(fp);
+    printf("Baseline written to %s\n", path);
+    return true;
+}
+
+bool BenchMetrics::compare(const char* path, double thresholdPct) const {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        printf("Unable to read baseline file %s - run with --update-baseline to create it.\n", path);
+        return false;
+    }
+
+    std::map<std::string, double> baseline;
+    char name[64];
+    double value;
+    while (fscanf(fp, "%63s %lf", name, &value) == 2)
+        baseline[name] = value;
+    fclose(fp);
+
+    bool passed = true;
+    printf("== Baseline comparison (threshold %.1f%%) ==\n", thresholdPct);
+    for (const Metric& m : metrics) {
+        auto it = baseline.find(m.name);
+        if (it == baseline.end()) {
+            printf("  %-24s %12.3f  (not in baseline)\n", m.name.c_str(), m.value);
+            continue;
+        }
+
+        double base = it->second;
+        // Positive change is always 'worse' regardless of the metric's direction.
+        double changePct = 0.0;
+        if (base != 0.0)
+            changePct = (m.higherIsBetter ? (base - m.value) : (m.value - base)) * 100.0 / std::fabs(base);
+        else if (m.higherIsBetter ? m.value < 0.0 : m.value > 0.0)
+            changePct = 100.0;      // e.g. dropped events: anything worse than a zero baseline regresses
+
+        bool regressed = changePct > thresholdPct;
+        printf("  %-24s %12.3f  baseline %12.3f  %+7.1f%% %s\n", m.name.c_str(), m.value, base,
+               m.higherIsBetter ? -changePct : changePct, regressed ? "REGRESSED" : "ok");
+        if (regressed)
+            passed = false;
+    }
+
+    return passed;
+}
+
+////////////////////////////////////////
+//
+//  B e n c h O p t i o n s
+//
+////////////////////////////////////////
+
+bool BenchOptions::parse(int argc, char** argv) {
+    for (int i = 0; i < argc; i++) {
+        if (!strcmp(argv[i], "--baseline") && i+1 < argc)
+            baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--update-baseline"))
+            updateBaseline = true;
+        else if (!strcmp(argv[i], "--threshold") && i+1 < argc)
+            thresholdPct = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i+1 < argc)
+            frames = (uint32_t)atol(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i+1 < argc)
+            threads = (uint8_t)atoi(argv[++i]);
+        else {
+            printf("Unknown option: %s\n", argv[i]);
+            printf("Options: --baseline <file> --update-baseline --threshold <pct> --frames <n> --threads <n>\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+int BenchOptions::finish(const BenchMetrics& metrics) const {
+    if (!baselinePath)
+        return 0;
+
+    if (updateBaseline)
+        return metrics.save(baselinePath) ? 0 : 1;
+
+    return metrics.compare(baselinePath, thresholdPct) ? 0 : 1;
+}
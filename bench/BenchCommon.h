@@ -0,0 +1,136 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+//
+// Shared plumbing for the headless benchmarks (env:bench_native).
+// Nothing in here touches SDL - the display is a memory buffer whose flush just counts pixels.
+//
+
+#include "lvpp.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Microseconds from a monotonic clock. Only differences are meaningful.
+ */
+uint64_t benchNowUS();
+uint64_t benchNowNS();
+
+/**
+ * @brief Registers a SDL_HOR_RES x SDL_VER_RES display with no output and a scripted pointer.
+ * @param bufferDivider The draw buffer is (screen pixels / bufferDivider) just like the ESP32 hal.
+ */
+lv_disp_t* benchDisplayInit(uint16_t bufferDivider = 10);
+
+/**
+ * @brief Pixels flushed to the headless display since the last call. Resets the counter.
+ */
+uint32_t benchTakeFlushedPixels();
+
+/**
+ * @brief Sets the state the scripted pointer reports on the next indev read.
+ */
+void benchPointerSet(lv_coord_t x, lv_coord_t y, bool pressed);
+
+/**
+ * @brief Collects per-frame samples and reports percentiles.
+ */
+class FrameStats {
+public:
+    void add(double frameMS, uint32_t pixels);
+    void clear();
+    size_t frames() const { return frameMS.size(); };
+    double percentileMS(double pct) const;
+    double totalMS() const;
+    double fps() const;
+    double pixelsPerFrame() const;
+protected:
+    std::vector<double> frameMS;
+    uint64_t totalPixels = 0;
+};
+
+/**
+ * @brief A set of named metrics which can be saved to, and compared against, a baseline file.
+ * @details The file is plain text, one "name value" pair per line, so it diffs nicely in git.
+ */
+class BenchMetrics {
+public:
+    /**
+     * @param higherIsBetter fps-style metrics regress when they drop, timings regress when they grow.
+     */
+    void set(const char* name, double value, bool higherIsBetter);
+    void print(const char* title) const;
+    bool save(const char* path) const;
+    /**
+     * @brief Compares against the baseline file.
+     * @return false if any metric regressed by more than thresholdPct or the file is unreadable.
+     */
+    bool compare(const char* path, double thresholdPct) const;
+protected:
+    struct Metric {
+        std::string name;
+        double value;
+        bool higherIsBetter;
+    };
+    std::vector<Metric> metrics;
+};
+
+/**
+ * @brief Common command line handling for a benchmark: --baseline <file>, --update-baseline,
+ *        --threshold <pct>, --frames <n> and --threads <n> (band render threads, 1 = off).
+ */
+struct BenchOptions {
+    const char* baselinePath = nullptr;
+    bool updateBaseline = false;
+    double thresholdPct = 10.0;
+    uint32_t frames = 0;
+    uint8_t threads = 1;
+
+    bool parse(int argc, char** argv);
+    /**
+     * @brief Saves or compares depending on the options. Returns the process exit code.
+     */
+    int finish(const BenchMetrics& metrics) const;
+};
+
+int renderBench(int argc, char** argv);
+int blendBench(int argc, char** argv);
+int shadowBench(int argc, char** argv);
+int allocBench(int argc, char** argv);
+int canvasBench(int argc, char** argv);
+int layoutBench(int argc, char** argv);
+int handlesBench(int argc, char** argv);
+int gaugeBench(int argc, char** argv);
+int inputBench(int argc, char** argv);
+int telemetryBench(int argc, char** argv);
+int sensorsBench(int argc, char** argv);
+int chartBench(int argc, char** argv);
+int logBench(int argc, char** argv);
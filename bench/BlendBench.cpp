@@ -0,0 +1,234 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "DrawSimd.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//
+// Microbenchmark of the blend step alone: LVGL's lv_draw_sw_blend_basic() against drawSimdBlend()
+// at every SIMD level this CPU supports, on a full screen and on one default-sized draw buffer band.
+// Each SIMD result is checked pixel for pixel against the stock result, and every opacity of the fill
+// and image blend kernels against lv_color_mix() itself. Any difference fails the run.
+// With --threads N an extra column runs the best level in band mode on N threads.
+//
+
+struct BlendCase {
+    const char* name;
+    bool useSrc;
+    lv_opa_t opa;
+};
+
+static const BlendCase cases[] = {
+    { "fill",       false, LV_OPA_COVER },
+    { "fill_opa40", false, LV_OPA_40 },
+    { "copy",       true,  LV_OPA_COVER },
+    { "blend_opa40",true,  LV_OPA_40 },
+};
+
+struct BlendTarget {
+    lv_area_t area;
+    std::vector<lv_color_t> dest;
+    std::vector<lv_color_t> src;
+    lv_draw_sw_ctx_t ctx;
+
+    BlendTarget(lv_coord_t w, lv_coord_t h) : dest(w*h), src(w*h) {
+        area.x1 = 0;
+        area.y1 = 0;
+        area.x2 = w - 1;
+        area.y2 = h - 1;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.base_draw.buf = dest.data();
+        ctx.base_draw.buf_area = &area;
+        ctx.base_draw.clip_area = &area;
+        ctx.blend = lv_draw_sw_blend_basic;
+        reset();
+    }
+
+    void reset() {
+        srand(68);
+        for (size_t i = 0; i < dest.size(); i++) {
+            dest[i].full = (uint16_t)rand();
+            src[i].full = (uint16_t)rand();
+        }
+    }
+};
+
+typedef void (*blendFn)(lv_draw_ctx_t*, const lv_draw_sw_blend_dsc_t*);
+
+static double timeBlend(BlendTarget& t, const BlendCase& c, blendFn fn, uint32_t iterations) {
+    lv_draw_sw_blend_dsc_t dsc;
+    memset(&dsc, 0, sizeof(dsc));
+    dsc.blend_area = &t.area;
+    dsc.src_buf = c.useSrc ? t.src.data() : nullptr;
+    dsc.color = lv_palette_main(LV_PALETTE_BLUE);
+    dsc.mask_res = LV_DRAW_MASK_RES_FULL_COVER;
+    dsc.opa = c.opa;
+    dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+
+    t.reset();
+    uint64_t start = benchNowUS();
+    for (uint32_t i = 0; i < iterations; i++)
+        fn(&t.ctx.base_draw, &dsc);
+    uint64_t end = benchNowUS();
+
+    double seconds = (end - start) / 1e6;
+    return seconds > 0.0 ? (double)lv_area_get_size(&t.area) * iterations / seconds / 1e6 : 0.0;
+}
+
+// Pixels where drawSimdBlend() differs from lv_color_mix(fg, bg, opa), over every partial opacity, for the
+// current level. A row of 67 pixels covers whole vectors and a tail. Zero if the call went to LVGL.
+static uint32_t mixMismatches() {
+    BlendTarget t(67, 1);
+    uint32_t mismatches = 0;
+
+    for (int useSrc = 0; useSrc < 2; useSrc++) {
+        for (uint16_t opa = LV_OPA_MIN + 1; opa < LV_OPA_MAX; opa++) {
+            t.reset();
+            const std::vector<lv_color_t> before(t.dest);
+            lv_draw_sw_blend_dsc_t dsc;
+            memset(&dsc, 0, sizeof(dsc));
+            dsc.blend_area = &t.area;
+            dsc.src_buf = useSrc ? t.src.data() : nullptr;
+            dsc.color = t.src[opa % t.src.size()];
+            dsc.mask_res = LV_DRAW_MASK_RES_FULL_COVER;
+            dsc.opa = (lv_opa_t) opa;
+            dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+
+            uint32_t handled = drawSimdGetStats().accelerated;
+            drawSimdBlend(&t.ctx.base_draw, &dsc);
+            if (drawSimdGetStats().accelerated == handled)
+                return 0;
+
+            for (size_t i = 0; i < t.dest.size(); i++) {
+                lv_color_t fg = useSrc ? t.src[i] : dsc.color;
+                if (t.dest[i].full != lv_color_mix(fg, before[i], (uint8_t) opa).full)
+                    mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+int blendBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    // --frames is the number of full screens worth of pixels per measurement.
+    if (!opts.frames)
+        opts.frames = 500;
+
+    lv_init();
+    lv_disp_t* disp = benchDisplayInit();
+    // lv_draw_sw_blend_basic() looks at the display being refreshed for set_px_cb.
+    _lv_refr_set_disp_refreshing(disp);
+
+    const SimdLevel best = drawSimdDetect();
+    std::vector<SimdLevel> levels;
+    levels.push_back(SimdLevel::None);
+    if (best == SimdLevel::AVX2)
+        levels.push_back(SimdLevel::SSE2);
+    if (best != SimdLevel::None)
+        levels.push_back(best);
+
+    struct { const char* name; lv_coord_t w; lv_coord_t h; } sizes[] = {
+        { "screen", SDL_HOR_RES, SDL_VER_RES },
+        { "band",   SDL_HOR_RES, SDL_VER_RES / 10 },
+    };
+
+    BenchMetrics metrics;
+    bool allMatch = true;
+
+    printf("%-12s %-7s %12s", "case", "size", "stock Mpx/s");
+    for (SimdLevel l : levels)
+        printf(" %10s Mpx/s", drawSimdLevelName(l));
+    if (opts.threads > 1)
+        printf("  %ux bands Mpx/s", opts.threads);
+    printf("\n");
+
+    for (const BlendCase& c : cases) {
+        for (const auto& s : sizes) {
+            BlendTarget stockTarget(s.w, s.h);
+            BlendTarget simdTarget(s.w, s.h);
+            uint32_t iterations = opts.frames * (SDL_HOR_RES * SDL_VER_RES) / (s.w * s.h);
+
+            double stock = timeBlend(stockTarget, c, lv_draw_sw_blend_basic, iterations);
+            printf("%-12s %-7s %12.1f", c.name, s.name, stock);
+
+            std::string prefix = std::string(c.name) + "_" + s.name;
+            metrics.set((prefix + "_stock_mpx").c_str(), stock, true);
+
+            for (SimdLevel l : levels) {
+                drawSimdSetLevel(l);
+                double simd = timeBlend(simdTarget, c, drawSimdBlend, iterations);
+                printf(" %10.1f (x%.1f)", simd, stock > 0.0 ? simd / stock : 0.0);
+
+                if (memcmp(stockTarget.dest.data(), simdTarget.dest.data(), stockTarget.dest.size() * sizeof(lv_color_t))) {
+                    printf(" MISMATCH");
+                    allMatch = false;
+                }
+                if (l == levels.back())
+                    metrics.set((prefix + "_simd_mpx").c_str(), simd, true);
+            }
+
+            if (opts.threads > 1) {
+                drawSimdSetBandThreads(opts.threads);
+                double banded = timeBlend(simdTarget, c, drawSimdBlend, iterations);
+                drawSimdSetBandThreads(1);
+                printf(" %10.1f (x%.1f)", banded, stock > 0.0 ? banded / stock : 0.0);
+
+                if (memcmp(stockTarget.dest.data(), simdTarget.dest.data(), stockTarget.dest.size() * sizeof(lv_color_t))) {
+                    printf(" MISMATCH");
+                    allMatch = false;
+                }
+                metrics.set((prefix + "_banded_mpx").c_str(), banded, true);
+            }
+            printf("\n");
+        }
+    }
+
+    uint32_t mixDiffs = 0;
+    for (SimdLevel l : levels) {
+        drawSimdSetLevel(l);
+        uint32_t diffs = mixMismatches();
+        if (diffs)
+            printf("%s: %u pixels differ from lv_color_mix()\n", drawSimdLevelName(l), diffs);
+        mixDiffs += diffs;
+    }
+    metrics.set("mix_mismatches", mixDiffs, false);
+
+    drawSimdSetLevel(best);
+    metrics.print("Blend microbenchmark");
+
+    if (!allMatch || mixDiffs) {
+        printf("SIMD output differs from the stock renderer.\n");
+        return 1;
+    }
+    return opts.finish(metrics);
+}
@@ -0,0 +1,117 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "CanvasFormat.h"
+
+#include <vector>
+
+//
+// Full-screen canvas blit cost and memory for every color format lvppCanvasIndexed can use, plus true
+// color. Each format gets a SCREEN-sized canvas filled with varied pixels and is redrawn repeatedly with
+// nothing else on screen, so the time is the decode + blit of the canvas alone.
+//
+
+struct CanvasCase {
+    const char* name;
+    const char* metric;
+    lv_img_cf_t cf;
+    uint8_t bpp;
+};
+
+static const CanvasCase cases[] = {
+    { "true color",    "truecolor_ms", LV_IMG_CF_TRUE_COLOR,    16 },
+    { "indexed 8-bit", "indexed8_ms",  LV_IMG_CF_INDEXED_8BIT,  8 },
+    { "indexed 4-bit", "indexed4_ms",  LV_IMG_CF_INDEXED_4BIT,  4 },
+    { "indexed 2-bit", "indexed2_ms",  LV_IMG_CF_INDEXED_2BIT,  2 },
+    { "indexed 1-bit", "indexed1_ms",  LV_IMG_CF_INDEXED_1BIT,  1 },
+};
+
+static double blitMS(const CanvasCase& c, uint32_t frames, uint32_t& bytes) {
+    const lv_coord_t w = SDL_HOR_RES;
+    const lv_coord_t h = SDL_VER_RES;
+    bytes = c.bpp == 16 ? LV_CANVAS_BUF_SIZE_TRUE_COLOR(w, h) : canvasIndexedBytes(c.bpp, w, h);
+    std::vector<uint8_t> buffer(bytes);
+
+    // Pseudo-random content so no format benefits from uniform runs.
+    uint32_t seed = 1;
+    for (uint8_t& b : buffer) {
+        seed = seed * 1103515245U + 12345U;
+        b = seed >> 16;
+    }
+
+    lv_obj_t* scr = lv_obj_create(NULL);
+    lv_scr_load(scr);
+    lv_obj_t* canvas = lv_canvas_create(scr);
+    lv_canvas_set_buffer(canvas, buffer.data(), w, h, c.cf);
+    if (c.bpp != 16) {
+        for (uint16_t i = 0; i < (1U << c.bpp); i++)
+            lv_canvas_set_palette(canvas, (uint8_t)i, lv_color_hsv_to_rgb(i * 360 / (1U << c.bpp), 80, 80));
+    }
+    lv_refr_now(NULL);
+
+    uint64_t start = benchNowUS();
+    for (uint32_t i = 0; i < frames; i++) {
+        lv_obj_invalidate(canvas);
+        lv_refr_now(NULL);
+    }
+    double ms = (benchNowUS() - start) / 1000.0 / frames;
+
+    lv_obj_del(scr);
+    benchTakeFlushedPixels();
+    return ms;
+}
+
+int canvasBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 200;
+
+    lv_init();
+    benchDisplayInit();
+
+    BenchMetrics metrics;
+    printf("Format            blit ms   bytes\n");
+    for (const CanvasCase& c : cases) {
+        uint32_t bytes;
+        double ms = blitMS(c, opts.frames, bytes);
+        printf("  %-14s %8.3f %7u\n", c.name, ms, (unsigned)bytes);
+        metrics.set(c.metric, ms, false);
+    }
+
+    // What the chooser makes of a few budgets for the 12-color main screen background.
+    const uint32_t budgets[] = { 16U * 1024U, 48U * 1024U, 96U * 1024U, 256U * 1024U };
+    for (uint32_t budget : budgets) {
+        CanvasFormatChoice choice = chooseCanvasFormat(SDL_HOR_RES, SDL_VER_RES, 12, budget);
+        printf("Budget %4uKB -> %s (%u bytes)\n", (unsigned)(budget / 1024), canvasFormatName(choice), (unsigned)choice.bytes);
+    }
+
+    metrics.print("Canvas format benchmark");
+    return opts.finish(metrics);
+}
@@ -0,0 +1,164 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "HistoryChart.h"
+#include <cmath>
+#include <string>
+
+//
+// A history chart as its history grows: HistoryChart (min/max envelope per pixel column, sweep) against a
+// stock lv_chart line series in shift mode holding every sample. Both start full, then each frame appends one
+// column's worth of samples (history / width) and renders. The stock chart redraws every segment of the
+// whole series each frame; HistoryChart redraws one or two columns whatever the history length.
+//
+
+static const lv_coord_t chartWidth = 300;
+static const lv_coord_t chartHeight = 100;
+static const int16_t chartLow = 0;
+static const int16_t chartHigh = 100;
+
+// A slow swing with a little noise - deterministic so runs compare.
+class Signal {
+public:
+    int16_t next() {
+        seed = seed * 1103515245u + 12345u;
+        int16_t noise = (int16_t) ((seed >> 16) % 11) - 5;
+        return (int16_t) (50 + 40 * sin(n++ * 0.002)) + noise;
+    }
+protected:
+    uint32_t seed = 1;
+    uint32_t n = 0;
+};
+
+struct ChartRun {
+    FrameStats stats;
+    double appendNS = 0;
+};
+
+template <class Append>
+static void measure(uint32_t perFrame, uint32_t frames, Signal& signal, ChartRun& run, Append append) {
+    lv_refr_now(NULL);
+    benchTakeFlushedPixels();
+
+    uint64_t appendTotal = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        uint64_t start = benchNowNS();
+        for (uint32_t i = 0; i < perFrame; i++)
+            append(signal.next());
+        uint64_t appended = benchNowNS();
+        lv_refr_now(NULL);
+        appendTotal += appended - start;
+        run.stats.add((benchNowNS() - start) / 1e6, benchTakeFlushedPixels());
+    }
+    run.appendNS = (double) appendTotal / frames / perFrame;
+}
+
+static void runStock(uint32_t history, uint32_t frames, ChartRun& run) {
+    lv_obj_t* scr = lv_obj_create(NULL);
+    lv_scr_load(scr);
+    lv_obj_t* chart = lv_chart_create(scr);
+    lv_obj_set_size(chart, chartWidth, chartHeight);
+    lv_obj_align(chart, LV_ALIGN_CENTER, 0, 0);
+    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(chart, history);
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, chartLow, chartHigh);
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+    lv_chart_set_div_line_count(chart, 0, 0);
+    // No point markers - just the line, like HistoryChart.
+    lv_obj_set_style_size(chart, 0, LV_PART_INDICATOR);
+    lv_chart_series_t* series = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_DEEP_ORANGE), LV_CHART_AXIS_PRIMARY_Y);
+
+    Signal signal;
+    for (uint32_t i = 0; i < history; i++)
+        lv_chart_set_next_value(chart, series, signal.next());
+
+    measure(history / chartWidth, frames, signal, run, [&](int16_t v) {
+        lv_chart_set_next_value(chart, series, v);
+    });
+    lv_obj_del(scr);
+}
+
+static void runHistory(uint32_t history, uint32_t frames, ChartRun& run, HistoryChartStats& totals) {
+    lv_obj_t* scr = lv_obj_create(NULL);
+    lv_scr_load(scr);
+    const uint16_t perColumn = history / chartWidth;
+    // lvpp widgets are created on the active screen.
+    HistoryChart* chart = new HistoryChart("chart", chartWidth, chartHeight, chartLow, chartHigh, perColumn);
+    chart->align(LV_ALIGN_CENTER, 0, 0);
+    chart->setColors(lv_palette_main(LV_PALETTE_DEEP_ORANGE), lv_color_white());
+
+    Signal signal;
+    for (uint32_t i = 0; i < history; i++)
+        chart->append(signal.next());
+
+    HistoryChart::resetStats();
+    measure(perColumn, frames, signal, run, [&](int16_t v) {
+        chart->append(v);
+    });
+    totals = HistoryChart::getStats();
+    delete chart;
+    lv_obj_del(scr);
+}
+
+int chartBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 200;
+
+    lv_init();
+    benchDisplayInit();
+
+    BenchMetrics metrics;
+    printf("%dx%d chart, %u frames, one column of samples appended per frame\n", chartWidth, chartHeight, (unsigned) opts.frames);
+
+    // lv_chart counts points in a uint16_t, so the stock chart tops out below 65536.
+    static const uint32_t histories[] = { chartWidth, chartWidth * 10, chartWidth * 100 };
+    for (uint32_t history : histories) {
+        ChartRun stock, ours;
+        HistoryChartStats totals;
+        runStock(history, opts.frames, stock);
+        runHistory(history, opts.frames, ours, totals);
+
+        printf("%6u samples  lv_chart     frame p50 %7.3f ms  p99 %7.3f ms  %7.0f px/frame  append %6.1f ns\n",
+               history, stock.stats.percentileMS(50), stock.stats.percentileMS(99), stock.stats.pixelsPerFrame(), stock.appendNS);
+        printf("%6u samples  HistoryChart frame p50 %7.3f ms  p99 %7.3f ms  %7.0f px/frame  append %6.1f ns  %.1f columns drawn/frame\n",
+               history, ours.stats.percentileMS(50), ours.stats.percentileMS(99), ours.stats.pixelsPerFrame(), ours.appendNS,
+               (double) totals.columnsDrawn / opts.frames);
+
+        std::string size = std::to_string(history);
+        metrics.set(("lv_chart_" + size + "_frame_p50_ms").c_str(), stock.stats.percentileMS(50), false);
+        metrics.set(("history_" + size + "_frame_p50_ms").c_str(), ours.stats.percentileMS(50), false);
+        metrics.set(("history_" + size + "_pixels_per_frame").c_str(), ours.stats.pixelsPerFrame(), false);
+        metrics.set(("history_" + size + "_append_ns").c_str(), ours.appendNS, false);
+    }
+
+    metrics.print("History chart benchmark");
+    return opts.finish(metrics);
+}
@@ -0,0 +1,119 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "Widgets.h"
+
+//
+// Dozens of TempGauges on one screen, updated every frame with mostly repeated values and occasional band
+// changes, against a gauge that restyles on every update the way TempGauge used to (HSV conversion plus
+// arc and label color on each setValue()). Reports update cost and the resulting frame time.
+//
+
+class RestylingGauge : public lvppArc {
+public:
+    RestylingGauge() : lvppArc("Restyling") {
+        setRange(TEMP_GAUGE_MIN, TEMP_GAUGE_MAX);
+        enableValueLabel(0, 0);
+        setValueLabelFormat("%d F");
+    };
+    void onValueChanged() {
+        curValue = lv_arc_get_value(obj);
+        uint16_t h = curValue >= 95 ? 5 : (curValue >= 80 ? 30 : (curValue >= 70 ? 50 : 200));
+        lv_color_t tempColor = lv_color_hsv_to_rgb(h, 100, 100);
+        setValueLabelColor(tempColor);
+        setArcColor(tempColor);
+    };
+    void setTemp(uint8_t tempValue) { setValue(tempValue); };
+};
+
+// Mostly the same reading, a step within a band now and then, a band change rarely.
+static uint8_t reading(uint32_t frame, uint16_t gauge) {
+    uint32_t phase = (frame + gauge * 7) / 10;
+    static const uint8_t steps[] = { 65, 65, 66, 66, 66, 72, 72, 73, 85, 85, 84, 97, 97, 66 };
+    return steps[phase % sizeof(steps)];
+}
+
+template <class Gauge>
+static void run(const char* title, uint16_t count, uint32_t frames, BenchMetrics& metrics, const char* prefix) {
+    lv_obj_t* scr = lv_obj_create(NULL);
+    lv_scr_load(scr);
+    std::vector<Gauge*> gauges;
+    for (uint16_t i = 0; i < count; i++) {
+        Gauge* g = new Gauge();
+        lv_obj_set_parent(g->getObj(), scr);
+        g->setSize(60, 60);
+        g->align(LV_ALIGN_TOP_LEFT, (i % 8) * 40, (i / 8) * 40);
+        gauges.push_back(g);
+    }
+    lv_refr_now(NULL);
+    benchTakeFlushedPixels();
+
+    FrameStats stats;
+    uint64_t updateNS = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        uint64_t start = benchNowNS();
+        for (uint16_t i = 0; i < count; i++)
+            gauges[i]->setTemp(reading(f, i));
+        uint64_t updated = benchNowNS();
+        lv_refr_now(NULL);
+        updateNS += updated - start;
+        stats.add((benchNowNS() - start) / 1e6, benchTakeFlushedPixels());
+    }
+
+    double perUpdate = (double) updateNS / frames / count;
+    printf("%-22s update %7.1f ns/gauge   frame p50 %6.3f ms  p99 %6.3f ms   %8.0f px/frame\n", title, perUpdate,
+           stats.percentileMS(50), stats.percentileMS(99), stats.pixelsPerFrame());
+
+    std::string name(prefix);
+    metrics.set((name + "_update_ns").c_str(), perUpdate, false);
+    metrics.set((name + "_frame_p50_ms").c_str(), stats.percentileMS(50), false);
+
+    for (Gauge* g : gauges)
+        delete g;
+    lv_obj_del(scr);
+}
+
+int gaugeBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 300;
+
+    lv_init();
+    benchDisplayInit();
+
+    const uint16_t count = 48;
+    BenchMetrics metrics;
+    printf("%u gauges, %u frames\n", count, (unsigned) opts.frames);
+    run<RestylingGauge>("restyle every update", count, opts.frames, metrics, "restyling");
+    run<TempGauge>("TempGauge (LUT)", count, opts.frames, metrics, "tempgauge");
+
+    metrics.print("Gauge update benchmark");
+    return opts.finish(metrics);
+}
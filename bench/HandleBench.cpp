@@ -0,0 +1,127 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "WidgetHandle.h"
+
+#include <string>
+
+//
+// Cost of updating one widget as its screen grows: lvppScreen's by-name lookup and setObjValue() against
+// a WidgetHandle resolved once, and against a registry lookup by (run time hashed) name ID. The target is
+// the widget added last, so the name lookups see their worst case.
+//
+
+struct HandleResult {
+    double findNameNS, setNameNS, handleGetNS, handleSetNS, findIDNS;
+    uint32_t leaked;                                // stale handle plus registry slots left after the deletes
+};
+
+template <class F>
+static double perCallNS(uint32_t calls, F fn) {
+    uint64_t start = benchNowNS();
+    for (uint32_t i = 0; i < calls; i++)
+        fn(i);
+    return (double) (benchNowNS() - start) / calls;
+}
+
+static HandleResult measure(uint16_t widgets, uint32_t calls) {
+    lvppScreen* screen = new lvppScreen();
+    std::vector<std::string> names(widgets);
+    std::vector<lvppBar*> bars(widgets);
+    for (uint16_t i = 0; i < widgets; i++) {
+        names[i] = "bar" + std::to_string(i);
+        bars[i] = new lvppBar(names[i].c_str());
+        WidgetHandle<lvppBar>::of(bars[i]);
+        screen->addObject(bars[i]);
+    }
+
+    const char* target = names.back().c_str();
+    WidgetHandle<lvppBar> handle = WidgetHandle<lvppBar>::find(widgetID(target));
+    volatile uintptr_t sink = 0;
+
+    HandleResult r;
+    r.findNameNS = perCallNS(calls, [&](uint32_t) { sink = (uintptr_t) screen->findObj(target); });
+    r.setNameNS = perCallNS(calls, [&](uint32_t i) { screen->setObjValue(target, i % 100); });
+    r.handleGetNS = perCallNS(calls, [&](uint32_t) { sink = (uintptr_t) handle.get(); });
+    r.handleSetNS = perCallNS(calls, [&](uint32_t i) {
+        if (lvppBar* bar = handle.get())
+            bar->setValue(i % 100);
+    });
+    r.findIDNS = perCallNS(calls, [&](uint32_t) { sink = (uintptr_t) WidgetHandle<lvppBar>::find(widgetID(target)).get(); });
+    (void) sink;
+
+    for (lvppBar* bar : bars)
+        delete bar;
+    delete screen;
+
+    // Every slot was freed by the delete events, and the handle must know its widget is gone.
+    r.leaked = (handle.get() ? 1 : 0) + WidgetRegistry::count();
+    if (r.leaked)
+        printf("Stale handle or registry entries left after deleting %u widgets!\n", widgets);
+    return r;
+}
+
+int handlesBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 20000;
+
+    lv_init();
+    benchDisplayInit();
+
+    BenchMetrics metrics;
+    uint32_t leaked = 0;
+    const uint16_t sizes[] = { 10, 100, 500, 1000 };
+    printf("Widgets   findObj  setObjValue  handle get  handle set  find by ID   (ns per call)\n");
+    for (uint16_t widgets : sizes) {
+        if (widgets > WIDGET_REGISTRY_SIZE)
+            continue;
+        HandleResult r = measure(widgets, opts.frames);
+        printf("%7u %9.1f %12.1f %11.1f %11.1f %11.1f\n", widgets, r.findNameNS, r.setNameNS, r.handleGetNS,
+               r.handleSetNS, r.findIDNS);
+
+        char name[48];
+        snprintf(name, sizeof(name), "set_by_name_%u_ns", widgets);
+        metrics.set(name, r.setNameNS, false);
+        snprintf(name, sizeof(name), "set_by_handle_%u_ns", widgets);
+        metrics.set(name, r.handleSetNS, false);
+        snprintf(name, sizeof(name), "find_by_id_%u_ns", widgets);
+        metrics.set(name, r.findIDNS, false);
+        leaked += r.leaked;
+    }
+    metrics.set("leaked_handles", leaked, false);
+
+    metrics.print("Widget handle benchmark");
+    if (leaked) {
+        printf("Widget handles outlived their widgets.\n");
+        return 1;
+    }
+    return opts.finish(metrics);
+}
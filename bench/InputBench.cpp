@@ -0,0 +1,315 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "DrawSimd.h"
+#include "InputSampler.h"
+#include "LazyScreen.h"
+#include "WidgetHandle.h"
+#include "main_header.h"
+#include "Widgets.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+extern void instantiateCommonItems();
+
+//
+// Synthetic input load on the real widget set, the way field users hammer it. Pointer events are
+// injected at scripted times through the same InputSampler queue the touchscreen uses:
+//   --pattern taps    rapid taps on "+1 Min" (plus5)
+//   --pattern mixed   plus5, cycling lights, opening and closing dropCycle, camSwitch and Setup, whose
+//                     screen is left again through its Exit button (default)
+//   --rate <n>        taps per second within a burst (default 20)
+//   --burst <n>       taps per burst, then a one second pause; 0 taps steadily (default 8)
+// A run is --frames ticks without input, for the frame-time baseline, then --frames ticks with input.
+// Time is scripted - a tick advances lv_tick by LV_DISP_DEF_REFR_PERIOD - so runs are reproducible.
+//
+// Handling latency of an event is its wait in scripted time, from injection until the tick whose
+// lv_timer_handler() reads it, plus the real time that handler took to dispatch it to the widget
+// (LV_EVENT_PRESSED / LV_EVENT_RELEASED). An event the widget never received within a second is dropped.
+// Taps landing while a screen transition runs hit no widget; they are counted as missed, not dropped.
+//
+static const uint32_t defaultFrames = 1000;
+static const uint64_t tickUS = LV_DISP_DEF_REFR_PERIOD * 1000;
+static const uint64_t holdUS = 40000;
+static const uint64_t burstPauseUS = 1000000;
+static const uint64_t dropAfterUS = 1000000;
+
+struct InputTarget {
+    const char* name;
+    uint32_t id;
+};
+
+static const InputTarget plus5Target  = { "+5Min", WIDGET_ID("+5Min") };
+static const InputTarget exitTarget   = { "ExitSetup", WIDGET_ID("ExitSetup") };
+// One field user's round on the main screen. dropCycle twice: the second tap closes its list again.
+static const InputTarget mixedRound[] = {
+    plus5Target,
+    { "Lights", WIDGET_ID("Lights") },
+    { "DropCycle", WIDGET_ID("DropCycle") },
+    { "DropCycle", WIDGET_ID("DropCycle") },
+    { "cam", WIDGET_ID("cam") },
+    plus5Target,
+    { "Setup", WIDGET_ID("Setup") },
+};
+
+struct PendingEvent {
+    lv_obj_t* obj;
+    bool press;
+    uint64_t injectedUS;        // scripted time
+};
+
+struct InputLoad {
+    bool mixed = true;
+    uint32_t rate = 20;
+    uint32_t burst = 8;
+
+    // Generator state
+    uint64_t nextTapUS = 0;
+    uint32_t tapsInBurst = 0;
+    uint32_t round = 0;
+    bool releaseDue = false;
+    uint64_t releaseUS = 0;
+    lv_point_t point;
+
+    // Measurements
+    std::deque<PendingEvent> pending;
+    std::vector<lv_obj_t*> hooked;
+    std::vector<double> latencyMS;
+    uint64_t tickStartUS = 0;   // scripted time of the tick being handled
+    uint64_t handlerStartUS = 0;
+    uint32_t injected = 0;
+    uint32_t missed = 0;
+    uint32_t dropped = 0;
+};
+
+static InputLoad load;
+
+static void handledEvent(lv_event_t* e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t* obj = lv_event_get_current_target(e);
+    bool press = code == LV_EVENT_PRESSED;
+
+    for (auto it = load.pending.begin(); it != load.pending.end(); ++it) {
+        if (it->obj == obj && it->press == press) {
+            double waitMS = (load.tickStartUS - it->injectedUS) / 1000.0;
+            load.latencyMS.push_back(waitMS + (benchNowUS() - load.handlerStartUS) / 1000.0);
+            load.pending.erase(it);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief The widget the next tap goes to, or nullptr while no screen with targets is showing.
+ */
+static lv_obj_t* nextTarget() {
+    lvppScreen* setup = pScreenSetup->isBuilt() ? pScreenSetup->getScreen() : nullptr;
+    const InputTarget* target;
+    if (lv_scr_act() == pScreenMain->getScreen())
+        target = load.mixed ? &mixedRound[load.round++ % (sizeof(mixedRound) / sizeof(mixedRound[0]))] : &plus5Target;
+    else if (setup && lv_scr_act() == setup->getScreen())
+        target = &exitTarget;
+    else
+        return nullptr;
+
+    lvppBase* widget = WidgetHandle<lvppBase>::find(target->id).get();
+    if (!widget) {
+        printf("Input target %s not found.\n", target->name);
+        return nullptr;
+    }
+
+    lv_obj_t* obj = widget->getObj();
+    if (std::find(load.hooked.begin(), load.hooked.end(), obj) == load.hooked.end()) {
+        lv_obj_add_event_cb(obj, handledEvent, LV_EVENT_PRESSED, nullptr);
+        lv_obj_add_event_cb(obj, handledEvent, LV_EVENT_RELEASED, nullptr);
+        load.hooked.push_back(obj);
+    }
+    return obj;
+}
+
+static void inject(lv_obj_t* obj, bool pressed, uint64_t atUS) {
+    benchPointerSet(load.point.x, load.point.y, pressed);
+    InputSampler::get()->sampleNow();
+    load.injected++;
+    if (obj)
+        load.pending.push_back(PendingEvent{ obj, pressed, atUS });
+}
+
+/**
+ * @brief Injects every press and release scheduled up to nowUS, in order.
+ */
+static void generate(uint64_t nowUS) {
+    static lv_obj_t* tapped = nullptr;
+    uint64_t spacingUS = 1000000 / std::max<uint32_t>(load.rate, 1);
+    uint64_t hold = std::min(holdUS, spacingUS / 2);
+
+    while (true) {
+        if (load.releaseDue && load.releaseUS <= nowUS) {
+            load.releaseDue = false;
+            inject(tapped, false, load.releaseUS);
+            continue;
+        }
+        if (load.releaseDue || load.nextTapUS > nowUS)
+            break;
+
+        uint64_t at = load.nextTapUS;
+        tapped = nextTarget();
+        if (tapped) {
+            lv_area_t area;
+            lv_obj_get_coords(tapped, &area);
+            load.point.x = (area.x1 + area.x2) / 2;
+            load.point.y = (area.y1 + area.y2) / 2;
+        } else {
+            // Mid-transition: tap the middle of the screen like an impatient user.
+            load.point.x = SDL_HOR_RES / 2;
+            load.point.y = SDL_VER_RES / 2;
+            load.missed += 2;
+        }
+        inject(tapped, true, at);
+        load.releaseDue = true;
+        load.releaseUS = at + hold;
+
+        load.nextTapUS = at + spacingUS;
+        if (load.burst && ++load.tapsInBurst >= load.burst) {
+            load.tapsInBurst = 0;
+            load.nextTapUS += burstPauseUS;
+        }
+    }
+}
+
+static void dropStale(uint64_t nowUS) {
+    while (!load.pending.empty() && nowUS - load.pending.front().injectedUS > dropAfterUS) {
+        load.dropped++;
+        load.pending.pop_front();
+    }
+}
+
+/**
+ * @brief Runs frames ticks. Returns the real time lv_timer_handler() took per scripted second, in ms.
+ */
+static double runTicks(uint32_t frames, bool withInput, uint64_t& scriptUS, FrameStats& stats) {
+    uint64_t busyUS = 0;
+    for (uint32_t tick = 0; tick < frames; tick++) {
+        scriptUS += tickUS;
+        pTheBrain->updateUI();
+        if (withInput)
+            generate(scriptUS);
+        lv_tick_inc(LV_DISP_DEF_REFR_PERIOD);
+
+        load.tickStartUS = scriptUS;
+        load.handlerStartUS = benchNowUS();
+        lv_timer_handler();
+        uint64_t end = benchNowUS();
+        busyUS += end - load.handlerStartUS;
+
+        uint32_t pixels = benchTakeFlushedPixels();
+        if (pixels)
+            stats.add((end - load.handlerStartUS) / 1000.0, pixels);
+        dropStale(scriptUS);
+    }
+    return busyUS / 1000.0 / (frames * tickUS / 1000000.0);
+}
+
+static double percentile(std::vector<double> values, double pct) {
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(pct / 100.0 * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+int inputBench(int argc, char** argv) {
+    // Our own options first, the rest are the common ones.
+    std::vector<char*> rest;
+    for (int i = 0; i < argc; i++) {
+        if (!strcmp(argv[i], "--pattern") && i+1 < argc)
+            load.mixed = strcmp(argv[++i], "taps") != 0;
+        else if (!strcmp(argv[i], "--rate") && i+1 < argc)
+            load.rate = (uint32_t)atol(argv[++i]);
+        else if (!strcmp(argv[i], "--burst") && i+1 < argc)
+            load.burst = (uint32_t)atol(argv[++i]);
+        else
+            rest.push_back(argv[i]);
+    }
+    BenchOptions opts;
+    if (!opts.parse((int)rest.size(), rest.data())) {
+        printf("Input options: --pattern taps|mixed --rate <taps/s> --burst <taps>\n");
+        return 2;
+    }
+    if (!opts.frames)
+        opts.frames = defaultFrames;
+
+    lv_init();
+    benchDisplayInit();
+    InputSampler::attach();
+    drawSimdInstall();
+    drawSimdSetBandThreads(opts.threads);
+    instantiateWidgets();
+    instantiateCommonItems();
+    // The ticks drive TheBrain's UI update instead of its own thread, as in the render benchmark.
+    pTheBrain->Pause();
+    lv_refr_now(NULL);
+    benchTakeFlushedPixels();
+
+    uint64_t scriptUS = 0;
+    FrameStats idleStats, loadedStats;
+    double idleBusy = runTicks(opts.frames, false, scriptUS, idleStats);
+
+    InputSampler::resetStats();
+    load.nextTapUS = scriptUS;
+    double loadedBusy = runTicks(opts.frames, true, scriptUS, loadedStats);
+    // Whatever is still waiting after the run gets one more second of idle ticks to arrive.
+    FrameStats drainStats;
+    runTicks((uint32_t)(dropAfterUS / tickUS) + 1, false, scriptUS, drainStats);
+
+    uint32_t handled = (uint32_t)load.latencyMS.size();
+    const InputLatencyStats& sampler = InputSampler::getStats();
+
+    BenchMetrics metrics;
+    metrics.set("input_latency_p50_ms", percentile(load.latencyMS, 50), false);
+    metrics.set("input_latency_p99_ms", percentile(load.latencyMS, 99), false);
+    metrics.set("input_latency_max_ms", percentile(load.latencyMS, 100), false);
+    // Queue overflows are in here too - their events never reach a widget.
+    metrics.set("input_dropped", load.dropped, false);
+    metrics.set("frame_p99_ms", loadedStats.percentileMS(99), false);
+    metrics.set("frame_p99_idle_ms", idleStats.percentileMS(99), false);
+    metrics.set("ui_busy_ms_per_s", loadedBusy, false);
+    metrics.set("ui_busy_idle_ms_per_s", idleBusy, false);
+
+    printf("Pattern %s, %u taps/s, bursts of %u: %u events injected, %u handled, %u dropped, %u missed (screen changing), %u queue overflows\n",
+           load.mixed ? "mixed" : "taps", load.rate, load.burst, load.injected, handled, load.dropped, load.missed, sampler.overflows.load());
+    printf("Frames with input: %u (p50 %.2f ms), without: %u (p50 %.2f ms)\n", (unsigned)loadedStats.frames(),
+           loadedStats.percentileMS(50), (unsigned)idleStats.frames(), idleStats.percentileMS(50));
+    InputSampler::report();
+    metrics.print("Input benchmark");
+
+    return opts.finish(metrics);
+}
@@ -0,0 +1,138 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "GlyphCache.h"
+#include "UiLayout.h"
+#include "SetupLayout.h"
+
+//
+// Building the setup screen from its compiled layout (src/SetupLayout.h) against the same screen built
+// by hand-written setter calls, the way instantiateWidgets() used to. Each round creates the screen and
+// its widgets and deletes them again; the layout is validated once, outside the timing, like at boot.
+//
+
+static void buildImperative(lvppScreen* screen, std::vector<lvppBase*>& created) {
+    lvppBase::removeDefaultBGColor();
+
+    lvppLabel* hello = new lvppLabel("title", "Setup Screen Example");
+    hello->align(LV_ALIGN_TOP_MID, 0, 3);
+    created.push_back(hello);
+    screen->addObject(hello);
+
+    lvppBase::setDefaultFont(GlyphCache::wrap(&lv_font_montserrat_22));
+    lvppBase::setDefaultBGColor(lv_palette_lighten(LV_PALETTE_GREEN, 2));
+    lvppBase::setDefaultTextColor(lv_palette_darken(LV_PALETTE_DEEP_ORANGE, 1));
+
+    lvppLabel* biggerDefLabel = new lvppLabel("def1", "Test 22pt orange/green");
+    biggerDefLabel->align(LV_ALIGN_CENTER, 0, -60);
+    biggerDefLabel->setColorGradient(lv_palette_main(LV_PALETTE_BLUE), lv_palette_main(LV_PALETTE_AMBER), LV_GRAD_DIR_HOR);
+    created.push_back(biggerDefLabel);
+    screen->addObject(biggerDefLabel);
+
+    lvppBase::removeDefaultBGColor();
+
+    lvppButton* bigButton = new lvppButton("def2");
+    bigButton->align(LV_ALIGN_CENTER, 0, 40);
+    bigButton->setText("Big Default");
+    bigButton->setColorGradient(lv_palette_main(LV_PALETTE_LIGHT_BLUE), lv_palette_main(LV_PALETTE_LIGHT_GREEN), LV_GRAD_DIR_HOR);
+    bigButton->setAdjText("Adjacent label", 0, 35);
+    bigButton->setAdjBGColor(lv_palette_lighten(LV_PALETTE_BLUE, 2));
+    created.push_back(bigButton);
+    screen->addObject(bigButton);
+
+    lvppBase::setDefaultBGColor(lv_palette_darken(LV_PALETTE_TEAL, 1));
+
+    lvppBar* bar1 = new lvppBar("defslider");
+    bar1->setSize(15, 100);
+    bar1->align(LV_ALIGN_BOTTOM_LEFT, 5, -5);
+    bar1->setColorGradient(lv_palette_main(LV_PALETTE_AMBER), lv_palette_main(LV_PALETTE_INDIGO), LV_GRAD_DIR_VER);
+    bar1->setValue(35);
+    created.push_back(bar1);
+    screen->addObject(bar1);
+
+    lvppButton* exitSetupButton = new lvppButton("ExitSetup", "Exit");
+    exitSetupButton->align(LV_ALIGN_BOTTOM_RIGHT, -3, -3);
+    exitSetupButton->setCallbackOnClicked([]() -> void {});
+    created.push_back(exitSetupButton);
+    screen->addObject(exitSetupButton);
+}
+
+static double roundsUS(uint32_t rounds, std::function<void(lvppScreen*, std::vector<lvppBase*>&)> build) {
+    std::vector<lvppBase*> created;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < rounds; i++) {
+        uint64_t start = benchNowUS();
+        lvppScreen* screen = new lvppScreen();
+        build(screen, created);
+        total += benchNowUS() - start;
+
+        for (lvppBase* widget : created)
+            delete widget;
+        created.clear();
+        delete screen;
+    }
+    return (double) total / rounds;
+}
+
+int layoutBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 200;
+
+    lv_init();
+    benchDisplayInit();
+
+    uint64_t start = benchNowNS();
+    UiLayout layout(setupLayout, sizeof(setupLayout));
+    double loadUS = (benchNowNS() - start) / 1000.0;
+    if (!layout.isValid()) {
+        printf("The compiled setup layout is invalid\n");
+        return 1;
+    }
+    UiLayout::bindCallback("exitSetup", []() -> void {});
+
+    double imperativeUS = roundsUS(opts.frames, buildImperative);
+    double layoutUS = roundsUS(opts.frames, [&layout](lvppScreen* screen, std::vector<lvppBase*>& created) {
+        layout.build(screen, created);
+    });
+    lvppBase::removeDefaultBGColor();
+
+    printf("Setup screen, %u widgets, %u byte layout\n", layout.getWidgetCount(), (unsigned) sizeof(setupLayout));
+    printf("  validate layout  %8.2f us\n", loadUS);
+    printf("  imperative build %8.2f us\n", imperativeUS);
+    printf("  layout build     %8.2f us\n", layoutUS);
+
+    BenchMetrics metrics;
+    metrics.set("layout_load_us", loadUS, false);
+    metrics.set("imperative_build_us", imperativeUS, false);
+    metrics.set("layout_build_us", layoutUS, false);
+    metrics.print("UI layout benchmark");
+    return opts.finish(metrics);
+}
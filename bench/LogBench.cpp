@@ -0,0 +1,188 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "TelemetryLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+
+//
+// TelemetryLog end to end, on local files:
+//   - burst   : producer threads log flat out at producerHz each for burstMS. Reports the rate written,
+//               append() latency (it must never wait for I/O), drops, write() calls and write amplification.
+//               The log is then reopened and appended to, as after a restart.
+//   - trickle : UI-event rates (trickleHz) for trickleMS, where part-filled blocks written every
+//               TELEMETRY_LOG_FLUSH_MS dominate the write amplification.
+//   - query   : the burst log memory-mapped, queried for random windows of 1% of its time span. Every
+//               answer is checked against a full scan (query_mismatches and lost_records must stay 0).
+//
+
+static const char* burstPath = "telemetry_bench.log";
+static const char* tricklePath = "telemetry_trickle.log";
+static const uint32_t producerHz = 50000;
+static const uint32_t burstMS = 1000;
+static const uint32_t reopenRecords = 10000;
+static const uint32_t trickleHz = 100;
+static const uint32_t trickleMS = 2500;
+static const uint32_t defaultQueries = 200;
+
+// Logs at hz from this thread until stop, spinning between records. Returns append() latencies.
+static void produce(uint8_t producer, uint32_t hz, std::atomic<bool>& stop, std::vector<uint32_t>& latencyNS) {
+    uint64_t next = benchNowNS();
+    int32_t value = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        uint64_t start = benchNowNS();
+        TelemetryLog::logInt(producer, value++);
+        latencyNS.push_back((uint32_t) (benchNowNS() - start));
+        next += 1000000000ull / hz;
+        while (benchNowNS() < next && !stop.load(std::memory_order_relaxed))
+            ;
+    }
+}
+
+static double percentile(std::vector<uint32_t>& v, double pct) {
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t) (pct / 100.0 * v.size()))];
+}
+
+static TelemetryLogStats runProducers(const char* path, uint8_t producers, uint32_t hz, uint32_t ms, std::vector<uint32_t>& latencyNS) {
+    unlink(path);
+    TelemetryLog::resetStats();
+    if (!TelemetryLog::open(path))
+        return TelemetryLogStats();
+
+    std::atomic<bool> stop(false);
+    std::vector<std::vector<uint32_t>> latencies(producers);
+    std::vector<std::thread> threads;
+    for (uint8_t p = 0; p < producers; p++) {
+        latencies[p].reserve((size_t) hz * ms / 1000 + 1024);
+        threads.emplace_back([&, p]() { produce(p, hz, stop, latencies[p]); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    stop = true;
+    for (std::thread& t : threads)
+        t.join();
+    TelemetryLog::close();
+
+    for (std::vector<uint32_t>& l : latencies)
+        latencyNS.insert(latencyNS.end(), l.begin(), l.end());
+    return TelemetryLog::getStats();
+}
+
+int logBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    uint8_t producers = opts.threads > 1 ? opts.threads : 4;
+    uint32_t queries = opts.frames ? opts.frames : defaultQueries;
+    BenchMetrics metrics;
+
+    // Burst
+    std::vector<uint32_t> latencyNS;
+    uint64_t start = benchNowNS();
+    TelemetryLogStats burst = runProducers(burstPath, producers, producerHz, burstMS, latencyNS);
+    double seconds = (benchNowNS() - start) / 1e9;
+    printf("burst: %u producers at %u records/s for %u ms\n", producers, producerHz, burstMS);
+    printf("  %u records written (%.0f/s), %u dropped, %u data + %u index blocks, %u writes, %u partial flushes, %llu bytes\n",
+           burst.records, burst.records / seconds, burst.dropped, burst.dataBlocks, burst.indexBlocks, burst.writes,
+           burst.partialFlushes, (unsigned long long) burst.bytesWritten);
+    printf("  append p50 %.0f ns, p99 %.0f ns, max %.0f ns, write amplification %.3f\n", percentile(latencyNS, 50),
+           percentile(latencyNS, 99), percentile(latencyNS, 100), burst.writeAmplification());
+
+    // Restart: the same file again, appended to.
+    uint32_t expected = burst.records;
+    if (TelemetryLog::open(burstPath)) {
+        for (uint32_t i = 0; i < reopenRecords; i++)
+            while (!TelemetryLog::logInt(0, (int32_t) i))
+                std::this_thread::yield();
+        TelemetryLog::close();
+        expected += TelemetryLog::getStats().records - burst.records;
+    }
+
+    // Trickle
+    std::vector<uint32_t> trickleNS;
+    TelemetryLogStats trickle = runProducers(tricklePath, 1, trickleHz, trickleMS, trickleNS);
+    printf("trickle: %u records/s for %u ms - %u records, %u partial flushes, %llu bytes, write amplification %.2f\n",
+           trickleHz, trickleMS, trickle.records, trickle.partialFlushes, (unsigned long long) trickle.bytesWritten,
+           trickle.writeAmplification());
+
+    // Query
+    TelemetryLogReader reader;
+    uint32_t mismatches = 0, lost = expected;
+    std::vector<uint32_t> queryNS;
+    double blocksPerQuery = 0;
+    if (reader.open(burstPath)) {
+        std::vector<uint64_t> times;
+        times.reserve(expected);
+        reader.query(0, UINT64_MAX, [&](const TelemetryRecord& r) { times.push_back(r.timeUS); });
+        lost = expected > times.size() ? expected - (uint32_t) times.size() : 0;
+        std::sort(times.begin(), times.end());
+
+        if (!times.empty()) {
+            uint64_t first = times.front(), span = times.back() - first + 1;
+            uint64_t window = span / 100 + 1;
+            uint32_t seed = 7;
+            uint32_t blocksBefore = reader.getBlocksRead();
+            for (uint32_t q = 0; q < queries; q++) {
+                seed = seed * 1103515245u + 12345u;
+                uint64_t from = first + (uint64_t) (seed >> 8) % span;
+                uint64_t to = from + window;
+                uint64_t qStart = benchNowNS();
+                uint32_t found = reader.query(from, to, [](const TelemetryRecord&) {});
+                queryNS.push_back((uint32_t) (benchNowNS() - qStart));
+                size_t truth = std::upper_bound(times.begin(), times.end(), to) - std::lower_bound(times.begin(), times.end(), from);
+                if (found != truth)
+                    mismatches++;
+            }
+            blocksPerQuery = (double) (reader.getBlocksRead() - blocksBefore) / queries;
+        }
+        printf("query: %u blocks, %u queries of 1%% of the time span, p50 %.1f us, %.1f blocks read per query, %u bad blocks\n",
+               reader.getBlockCount(), queries, percentile(queryNS, 50) / 1000.0, blocksPerQuery, reader.getBadBlocks());
+        reader.close();
+    }
+    printf("%u records expected after the restart, %u lost, %u query mismatches\n", expected, lost, mismatches);
+    unlink(burstPath);
+    unlink(tricklePath);
+
+    metrics.set("records_per_s", burst.records / seconds, true);
+    metrics.set("append_p99_ns", percentile(latencyNS, 99), false);
+    metrics.set("dropped", burst.dropped, false);
+    metrics.set("write_amplification", burst.writeAmplification(), false);
+    metrics.set("trickle_write_amplification", trickle.writeAmplification(), false);
+    metrics.set("query_p50_us", percentile(queryNS, 50) / 1000.0, false);
+    metrics.set("query_blocks_read", blocksPerQuery, false);
+    metrics.set("query_mismatches", mismatches, false);
+    metrics.set("lost_records", lost, false);
+    metrics.print("Telemetry log benchmark");
+
+    return opts.finish(metrics);
+}
@@ -0,0 +1,196 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "DrawSimd.h"
+#include "BitmapCache.h"
+#include "TransformCache.h"
+#include "GlyphCache.h"
+#include "HeapScope.h"
+#include "LazyScreen.h"
+#include "BootProfiler.h"
+#include "ScreenTransition.h"
+#include "InputSampler.h"
+#include "main_header.h"
+#include "Widgets.h"
+
+extern void instantiateCommonItems();
+
+//
+// Scripted scenario for the real widget set from Widgets.cpp.
+// One 'tick' is one display refresh period. The script repeats every scenarioLength ticks:
+//   - every tick      : TheBrain-style UI update (gauge, water bar, time status)
+//   - ticks 10 & 30   : click the "Cycle Pulsing" dropdown (open, then close)
+//   - tick 50         : click the camera switch
+//   - tick 80         : Setup screen via activateScreen(500, LV_SCR_LOAD_ANIM_OVER_LEFT)
+//   - tick 180        : back to main via ScreenTransition::activate(pScreenMain, 500, LV_SCR_LOAD_ANIM_OVER_RIGHT)
+// Both transitions run from snapshots within SCREEN_TRANSITION_BUDGET; their frames are also reported
+// separately (transition_frame_*), so -D SCREEN_TRANSITION_BUDGET=0 shows the live-animation cost.
+//
+static const uint32_t scenarioLength = 200;
+// Ticks a 500ms transition spans.
+static const uint32_t transitionTicks = 500 / LV_DISP_DEF_REFR_PERIOD + 1;
+static const uint32_t defaultFrames  = 1000;
+
+// Centers of the clicked widgets as laid out in instantiateWidgets().
+// dropCycle: 148x42 aligned LV_ALIGN_BOTTOM_LEFT, 5, -40
+static const lv_coord_t dropX = 5 + 148/2;
+static const lv_coord_t dropY = SDL_VER_RES - 40 - 42/2;
+// camSwitch: 40x20 aligned LV_ALIGN_LEFT_MID, 10, -35
+static const lv_coord_t camX  = 10 + 40/2;
+static const lv_coord_t camY  = SDL_VER_RES/2 - 35;
+
+static void scriptStep(uint32_t tick) {
+    uint32_t step = tick % scenarioLength;
+
+    pTheBrain->updateUI();
+
+    switch (step) {
+    case 10:
+    case 30:
+        benchPointerSet(dropX, dropY, true);
+        break;
+    case 50:
+        benchPointerSet(camX, camY, true);
+        break;
+    case 11:
+    case 31:
+        benchPointerSet(dropX, dropY, false);
+        break;
+    case 51:
+        benchPointerSet(camX, camY, false);
+        break;
+    case 80:
+        pScreenSetup->activateScreen(500, LV_SCR_LOAD_ANIM_OVER_LEFT);
+        break;
+    case 180:
+        ScreenTransition::activate(pScreenMain, 500, LV_SCR_LOAD_ANIM_OVER_RIGHT);
+        break;
+    default:
+        break;
+    }
+}
+
+int renderBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = defaultFrames;
+
+    // Boot the same way the emulator does, profiled up to the first frame.
+    const uint32_t bootStart = BootProfiler::nowUS();
+    BootProfiler::begin("lv_init");
+    lv_init();
+    BootProfiler::next("display");
+    benchDisplayInit();
+    // The scripted pointer goes through the input queue like the real touch does. The sampler task stays
+    // paused - each tick samples once, right after the script moved the pointer.
+    InputSampler* sampler = InputSampler::attach();
+    // Same renderer setup as the emulator.
+    drawSimdInstall();
+    drawSimdSetBandThreads(opts.threads);
+    BootProfiler::end();
+    BootProfiler::watchFirstFrame();
+
+    BootProfiler::begin("instantiateWidgets");
+    instantiateWidgets();
+    BootProfiler::next("instantiateCommonItems");
+    instantiateCommonItems();
+    BootProfiler::end();
+
+    // TheBrain's own thread would update once per second. Here the script drives it every tick instead.
+    pTheBrain->Pause();
+
+    // Settle the first full-screen draw so it doesn't skew the percentiles.
+    lv_refr_now(NULL);
+    const double firstFrameMS = (BootProfiler::firstFrameUS() - bootStart) / 1000.0;
+    benchTakeFlushedPixels();
+
+    FrameStats stats;
+    FrameStats transitionStats;
+    uint32_t idleTicks = 0;
+    BitmapCache::resetStats();
+    InputSampler::resetStats();
+
+    for (uint32_t tick = 0; tick < opts.frames; tick++) {
+        scriptStep(tick);
+        sampler->sampleNow();
+        lv_tick_inc(LV_DISP_DEF_REFR_PERIOD);
+
+        uint64_t start = benchNowUS();
+        {
+            HeapScope scope("renderer");
+            lv_timer_handler();
+        }
+        uint64_t end = benchNowUS();
+
+        uint32_t pixels = benchTakeFlushedPixels();
+        if (pixels)
+            stats.add((end - start) / 1000.0, pixels);
+        else
+            idleTicks++;
+
+        // The 500ms screen transitions started at steps 80 and 180.
+        uint32_t step = tick % scenarioLength;
+        bool transitioning = (step >= 80 && step < 80 + transitionTicks) || (step >= 180 && step < 180 + transitionTicks);
+        if (pixels && transitioning)
+            transitionStats.add((end - start) / 1000.0, pixels);
+    }
+
+    BenchMetrics metrics;
+    metrics.set("fps", stats.fps(), true);
+    metrics.set("frame_p50_ms", stats.percentileMS(50), false);
+    metrics.set("frame_p99_ms", stats.percentileMS(99), false);
+    metrics.set("pixels_per_frame", stats.pixelsPerFrame(), false);
+    metrics.set("first_frame_ms", firstFrameMS, false);
+    metrics.set("transition_frame_p50_ms", transitionStats.percentileMS(50), false);
+    metrics.set("transition_frame_p99_ms", transitionStats.percentileMS(99), false);
+    metrics.set("touch_to_photon_p50_ms", InputSampler::latencyPercentileUS(50) / 1000.0, false);
+    metrics.set("touch_to_photon_max_ms", InputSampler::getStats().maxUS / 1000.0, false);
+
+    printf("Band threads: %u, banded blends: %u\n", drawSimdGetBandThreads(), drawSimdGetStats().banded);
+    BitmapCacheStats cache = BitmapCache::getStats();
+    printf("Bitmap cache: %u hits, %u misses, %u over budget, %u of %u bytes\n",
+           cache.hits, cache.misses, cache.rejected, cache.bytesInUse, cache.budget);
+    TransformCacheStats xform = TransformedImageCache::getStats();
+    printf("Transformed image cache: %u entries, %u hits, %u misses, %u evictions, %u bytes\n",
+           xform.entries, xform.hits, xform.misses, xform.evictions, xform.bytesInUse);
+    GlyphCacheStats glyphs = GlyphCache::getStats();
+    printf("Glyph cache: %u entries, %u hits, %u misses (%.1f%% hit rate), %u bytes\n",
+           glyphs.entries, glyphs.hits, glyphs.misses, glyphs.hitRate() * 100.0f, glyphs.bytesInUse);
+    HeapScope::report();
+    printf("Setup screen built %u times (lazily, on first show).\n", pScreenSetup->getBuildCount());
+    const ScreenTransitionStats& transitions = ScreenTransition::getStats();
+    printf("Screen transitions: %u from snapshots (last took %u us, %u bytes), %u live fallbacks\n",
+           transitions.snapshotted, transitions.snapshotUS, transitions.bytes, transitions.fallbacks);
+    InputSampler::report();
+    printf("Rendered %u frames (%u idle ticks) over %u scripted ticks.\n", (unsigned)stats.frames(), idleTicks, opts.frames);
+    metrics.print("Render benchmark");
+
+    return opts.finish(metrics);
+}
@@ -0,0 +1,103 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "SensorSim.h"
+
+//
+// The sensor data path at production rates: 18 sensors sampling at 10 kHz and four slow ones (1 Hz to
+// 1 kHz), every decimation mode, run in scripted time. The UI side takes one Telemetry snapshot per
+// display frame, as TheBrain::refreshUI() does, and must see fresh values in every frame.
+// Reports the cost per sample and how many times faster than real time the whole path runs.
+//
+
+static const uint32_t defaultFrames = 1000;
+
+int sensorsBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = defaultFrames;
+
+    const uint32_t windowMS = LV_DISP_DEF_REFR_PERIOD;
+    SensorSim sim(windowMS);
+    static const Decimation modes[] = { Decimation::Average, Decimation::Min, Decimation::Max, Decimation::Last };
+    char name[24];
+    for (uint16_t i = 0; i < 16; i++) {
+        snprintf(name, sizeof(name), "fast%u", i);
+        sim.add(name, 10000, { 50.0f, 3.0f, 1.0f, 8.0f, 0.2f, 0.0f, 100.0f }, modes[i % 4], i + 1);
+    }
+    for (uint16_t i = 0; i < 2; i++) {
+        snprintf(name, sizeof(name), "pressure%u", i);
+        sim.add(name, 10000, { 30.0f, 4.0f, 0.0f, 12.0f, 0.1f, 0.0f, 80.0f }, Decimation::MinMax, 100 + i);
+    }
+    const float slowRates[] = { 1.0f, 10.0f, 100.0f, 1000.0f };
+    for (uint16_t i = 0; i < 4; i++) {
+        snprintf(name, sizeof(name), "slow%u", i);
+        sim.add(name, slowRates[i], { 20.0f, 0.5f, 0.1f, 0.0f, 0.0f, 0.0f, 40.0f }, Decimation::Average, 200 + i);
+    }
+
+    uint64_t scriptUS = 0;
+    uint64_t busyNS = 0;
+    uint32_t shownVersion = 0, staleFrames = 0;
+    TelemetrySnapshot snap;
+    sim.step(scriptUS);
+
+    for (uint32_t frame = 0; frame < opts.frames; frame++) {
+        // The task's wake-ups within one frame.
+        for (uint32_t t = 0; t < windowMS; t += SENSOR_SIM_PERIOD_MS) {
+            scriptUS += SENSOR_SIM_PERIOD_MS * 1000;
+            uint64_t start = benchNowNS();
+            sim.step(scriptUS);
+            busyNS += benchNowNS() - start;
+        }
+        if (!Telemetry::read(snap, shownVersion))
+            staleFrames++;
+        shownVersion = snap.version;
+    }
+
+    const SensorStats& stats = sim.getStats();
+    double nsPerSample = (double) busyNS / stats.samples;
+    double realtime = scriptUS * 1000.0 / busyNS;
+
+    printf("%u sensors, %llu samples in %.1f s scripted, %llu windows published; %.1f ns/sample, %.0fx real time\n",
+           sim.count(), (unsigned long long) stats.samples, scriptUS / 1e6, (unsigned long long) stats.windows,
+           nsPerSample, realtime);
+    printf("UI frames without fresh values: %u of %u\n", staleFrames, opts.frames);
+    printf("Last frame: fast0 (average) %.1f, pressure0 %.1f in %.1f..%.1f\n", snap.getFloat(sim.getKey(0)),
+           snap.getFloat(Telemetry::find("pressure0")), snap.getFloat(Telemetry::find("pressure0.min")),
+           snap.getFloat(Telemetry::find("pressure0.max")));
+
+    BenchMetrics metrics;
+    metrics.set("ns_per_sample", nsPerSample, false);
+    metrics.set("realtime_factor", realtime, true);
+    metrics.set("stale_ui_frames", staleFrames, false);
+    metrics.print("Sensor simulation benchmark");
+
+    return opts.finish(metrics);
+}
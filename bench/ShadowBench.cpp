@@ -0,0 +1,126 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "ShadowLabel.h"
+
+//
+// TimeStatus-style shadowed text: the old twin-label approach against ShadowLabel.
+//   update - new text every frame (what TheBrain does once a second)
+//   redraw - same text, area invalidated by something else (an overlapping widget, a dropdown)
+//
+
+static const lv_coord_t boxW = 150;
+static const lv_coord_t boxH = 44;
+
+static lv_obj_t* makeBox() {
+    lv_obj_t* scr = lv_obj_create(NULL);
+    lv_scr_load(scr);
+    lv_obj_t* box = lv_obj_create(scr);
+    lv_obj_set_size(box, boxW, boxH);
+    lv_obj_center(box);
+    lv_refr_now(NULL);
+    benchTakeFlushedPixels();
+    return box;
+}
+
+template <typename SetText>
+static void measure(lv_obj_t* box, uint32_t frames, SetText setText, double& updateMS, double& redrawMS) {
+    char txt[16];
+    uint64_t start = benchNowUS();
+    for (uint32_t i = 0; i < frames; i++) {
+        snprintf(txt, sizeof(txt), "Time: %u", (unsigned)(i % 100));
+        setText(txt);
+        lv_refr_now(NULL);
+    }
+    updateMS = (benchNowUS() - start) / 1000.0 / frames;
+
+    start = benchNowUS();
+    for (uint32_t i = 0; i < frames; i++) {
+        lv_obj_invalidate(box);
+        lv_refr_now(NULL);
+    }
+    redrawMS = (benchNowUS() - start) / 1000.0 / frames;
+}
+
+int shadowBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    if (!opts.frames)
+        opts.frames = 2000;
+
+    lv_init();
+    benchDisplayInit();
+
+    double twinUpdate, twinRedraw, cachedUpdate, cachedRedraw;
+
+    {
+        lv_obj_t* box = makeBox();
+        static lv_style_t style_shadow;
+        lv_style_init(&style_shadow);
+        lv_style_set_text_opa(&style_shadow, LV_OPA_40);
+        lv_style_set_text_color(&style_shadow, lv_color_black());
+        lv_style_set_text_font(&style_shadow, &lv_font_montserrat_24);
+
+        lv_obj_t* shadow = lv_label_create(box);
+        lv_obj_add_style(shadow, &style_shadow, 0);
+        lv_obj_t* label = lv_label_create(box);
+        lv_obj_set_style_text_font(label, &lv_font_montserrat_24, 0);
+        lv_obj_center(label);
+        lv_obj_align_to(shadow, label, LV_ALIGN_TOP_LEFT, 1, 1);
+
+        measure(box, opts.frames, [&](const char* t) {
+            lv_label_set_text(label, t);
+            lv_label_set_text(shadow, t);
+        }, twinUpdate, twinRedraw);
+    }
+
+    uint32_t rasters;
+    {
+        lv_obj_t* box = makeBox();
+        lv_obj_update_layout(box);
+        ShadowLabel text(box, &lv_font_montserrat_24, lv_obj_get_content_width(box));
+        text.setShadow(lv_color_black(), LV_OPA_40, 1, 1);
+
+        measure(box, opts.frames, [&](const char* t) {
+            text.setText(t);
+        }, cachedUpdate, cachedRedraw);
+        rasters = text.getRasterCount();
+    }
+
+    BenchMetrics metrics;
+    metrics.set("twin_update_ms", twinUpdate, false);
+    metrics.set("twin_redraw_ms", twinRedraw, false);
+    metrics.set("shadowlabel_update_ms", cachedUpdate, false);
+    metrics.set("shadowlabel_redraw_ms", cachedRedraw, false);
+
+    printf("ShadowLabel rasterized %u times for %u updates and %u redraws.\n", rasters, opts.frames, opts.frames);
+    metrics.print("Shadowed text benchmark");
+
+    return opts.finish(metrics);
+}
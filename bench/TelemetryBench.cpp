@@ -0,0 +1,147 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BenchCommon.h"
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+//
+// Telemetry store costs: single set/get, a whole-store snapshot alone, and snapshots taken while writer
+// threads each write writerHz batches per second (five times the fastest simulated sensor). Every batch
+// writes a pair with b == -a, so a snapshot holding anything else is torn - that count must stay 0.
+// Writers flooding the store back to back would starve snapshots: a seqlock reader only succeeds
+// between writes. The store is meant for sensor-rate writers, not for that.
+//
+
+static const uint32_t defaultCalls = 1000000;
+static const uint32_t contendedMS = 300;
+static const uint32_t writerHz = 50000;
+
+int telemetryBench(int argc, char** argv) {
+    BenchOptions opts;
+    if (!opts.parse(argc, argv))
+        return 2;
+    uint32_t calls = opts.frames ? opts.frames : defaultCalls;
+    uint8_t writers = opts.threads > 1 ? opts.threads : 2;
+
+    // A realistically sized store: a few dozen unrelated values around the pair under test.
+    for (int i = 0; i < 24; i++) {
+        static char names[24][12];
+        snprintf(names[i], sizeof(names[i]), "filler%d", i);
+        Telemetry::addValue(names[i], (int32_t) i);
+    }
+    TelemetryKey a = Telemetry::addValue("pair.a", (int32_t) 0);
+    TelemetryKey b = Telemetry::addValue("pair.b", (int32_t) 0);
+
+    volatile int32_t sink = 0;
+    uint64_t start = benchNowNS();
+    for (uint32_t i = 0; i < calls; i++)
+        Telemetry::setInt(a, (int32_t) i);
+    double setNS = (double)(benchNowNS() - start) / calls;
+
+    start = benchNowNS();
+    for (uint32_t i = 0; i < calls; i++)
+        sink = Telemetry::getInt(a);
+    double getNS = (double)(benchNowNS() - start) / calls;
+
+    TelemetrySnapshot snap;
+    uint32_t since = 0;
+    start = benchNowNS();
+    for (uint32_t i = 0; i < calls; i++) {
+        Telemetry::read(snap, since);
+        since = snap.version;
+    }
+    double readNS = (double)(benchNowNS() - start) / calls;
+    (void) sink;
+    {
+        Telemetry::Batch batch;
+        batch.setInt(a, 0);
+        batch.setInt(b, 0);
+    }
+
+    // Writers flood the pair while this thread keeps taking snapshots.
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (uint8_t w = 0; w < writers; w++) {
+        threads.emplace_back([&, w]() {
+            int32_t v = w * 1000000;
+            uint64_t next = benchNowNS();
+            while (!stop.load(std::memory_order_relaxed)) {
+                {
+                    Telemetry::Batch batch;
+                    batch.setInt(a, v);
+                    batch.setInt(b, -v);
+                }
+                v++;
+                // Paced by spinning - sleeps this short aren't reliable.
+                next += 1000000000ull / writerHz;
+                while (benchNowNS() < next && !stop.load(std::memory_order_relaxed))
+                    ;
+            }
+        });
+    }
+
+    Telemetry::Stats before = Telemetry::getStats();
+    uint32_t snapshots = 0, torn = 0, updates = 0;
+    uint64_t worstNS = 0;
+    start = benchNowNS();
+    uint64_t end = start + contendedMS * 1000000ull;
+    uint64_t now;
+    while ((now = benchNowNS()) < end) {
+        if (Telemetry::read(snap, since))
+            updates++;
+        worstNS = std::max(worstNS, benchNowNS() - now);
+        since = snap.version;
+        if (snap.getInt(a) != -snap.getInt(b))
+            torn++;
+        snapshots++;
+    }
+    double contendedNS = (double)(now - start) / snapshots;
+    stop = true;
+    for (std::thread& t : threads)
+        t.join();
+    Telemetry::Stats after = Telemetry::getStats();
+    double retriesPerRead = (double)(after.retries - before.retries) / (after.reads - before.reads);
+
+    printf("set %.1f ns, get %.1f ns, snapshot of %u values %.1f ns\n", setNS, getNS, Telemetry::count(), readNS);
+    printf("%u writer threads at %u batches/s wrote %u batches; reader took %u snapshots (%u saw changes), %.1f ns each (worst %.1f us), %.3f retries/read, %u torn\n",
+           writers, writerHz, after.writes - before.writes, snapshots, updates, contendedNS, worstNS / 1000.0, retriesPerRead, torn);
+
+    BenchMetrics metrics;
+    metrics.set("set_ns", setNS, false);
+    metrics.set("get_ns", getNS, false);
+    metrics.set("snapshot_ns", readNS, false);
+    metrics.set("contended_snapshot_ns", contendedNS, false);
+    metrics.set("contended_snapshot_max_us", worstNS / 1000.0, false);
+    metrics.set("torn_snapshots", torn, false);
+    metrics.print("Telemetry benchmark");
+
+    return opts.finish(metrics);
+}
@@ -0,0 +1,84 @@
+/*******************************
+ * 
+ * FILE ONLY GETS COMPILED IN HEADLESS BENCHMARK MODE (env:bench_native)
+ * 
+ * ****************************/
+
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "lvpp.h"
+
+#include "main_header.h"
+#include "BenchCommon.h"
+
+#include <cstring>
+
+struct BenchEntry {
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* description;
+};
+
+static const BenchEntry benches[] = {
+    { "render", renderBench, "Scripted widget scenario - fps, p50/p99 frame time, pixels per frame" },
+    { "blend",  blendBench,  "SIMD RGB565 fill/blend/copy against the stock LVGL software blend" },
+    { "shadow", shadowBench, "TimeStatus shadowed text: twin labels against the cached ShadowLabel" },
+    { "alloc",  allocBench,  "LVGL-like allocation churn: pool/TLSF allocator against malloc, latency tails" },
+    { "canvas", canvasBench, "Full-screen canvas blit cost and memory per color format (true color, 8/4/2/1-bit)" },
+    { "layout", layoutBench, "Setup screen built from its compiled binary layout vs. hand-written setter calls" },
+    { "handles", handlesBench, "Widget update cost as a screen grows: by-name lookup vs. typed handles" },
+    { "gauge", gaugeBench, "48 TempGauges updated per frame: color LUT + no-op suppression vs. restyling every update" },
+    { "input", inputBench, "Bursty taps on the real UI: per-event handling latency, dropped events, frame time impact" },
+    { "telemetry", telemetryBench, "Telemetry store set/get/snapshot cost, and snapshots under writer threads (torn = 0)" },
+    { "sensors", sensorsBench, "22 simulated sensors up to 10 kHz decimated to display rate: ns/sample, real-time factor" },
+    { "chart", chartBench, "History chart against a stock lv_chart as history grows: frame time, pixels per frame" },
+    { "log", logBench, "Binary telemetry log: records/s, append latency, write amplification, mmap range queries" },
+};
+
+static void usage(const char* prog) {
+    printf("Usage: %s <benchmark> [options]\n", prog);
+    for (const BenchEntry& b : benches)
+        printf("  %-10s %s\n", b.name, b.description);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (const BenchEntry& b : benches) {
+        if (!strcmp(argv[1], b.name))
+            return b.run(argc-2, argv+2);
+    }
+
+    usage(argv[0]);
+    return 2;
+}
@@ -36,6 +36,12 @@
 
 #include "main_header.h"
 #include "Widgets.h"
+#include "DrawSimd.h"
+#include "HeapScope.h"
+#include "BootProfiler.h"
+#include "InputSampler.h"
+#include "SensorSim.h"
+#include "TelemetryLog.h"
 
 extern lv_obj_t* pSetupScreen;
 extern lv_obj_t* pMainScreen;
@@ -43,10 +49,29 @@ extern void instantiateCommonItems();
 
 int main(void)
 {
+    // SDL wants the main thread and the widgets need its display, so the emulator boots sequentially -
+    // see main_esp32.cpp for hardware bring-up running in parallel with widget construction.
+    BootProfiler::begin("lv_init");
 	lv_init();
 
+    BootProfiler::next("hal_setup");
 	hal_setup();
+    BootProfiler::end();
+    // The SDL mouse is sampled and queued with timestamps for touch-to-photon latency. Its state belongs to
+    // the LVGL thread, so it is read in LVGL's indev read (INPUT_SAMPLE_IN_READ) and the task isn't started.
+    // Before watchFirstFrame(), which puts back the monitor_cb it found.
+    InputSampler::attach();
+    BootProfiler::watchFirstFrame();
 
+    // Swap LVGL's software blend for the SSE2/AVX2/NEON one. Unsupported cases fall back automatically.
+    if (drawSimdInstall())
+        printf("SIMD blend enabled: %s\n", drawSimdLevelName(drawSimdGetLevel()));
+#if defined(RENDER_BAND_THREADS) && RENDER_BAND_THREADS > 1
+    // Optional: split large blends into bands rendered on RENDER_BAND_THREADS threads.
+    drawSimdSetBandThreads(RENDER_BAND_THREADS);
+#endif
+
+    BootProfiler::begin("theme");
    lv_theme_t * th = lv_theme_default_init(NULL, lv_palette_main(LV_PALETTE_BLUE), lv_palette_main(LV_PALETTE_BLUE_GREY), 
                                                 false, LV_FONT_DEFAULT);
 
@@ -54,23 +79,58 @@ int main(void)
 
 LV_LOG_USER("Ready to create widgets.\n");
     
+    BootProfiler::next("instantiateWidgets");
     instantiateWidgets();
 
 LV_LOG("Created widgets.\n");
 
+#if TELEMETRY_LOG
+    // Sensor values (as shown) and UI events, appended to a binary log by its own task - see TelemetryLog.h.
+    TelemetryLog::open(TELEMETRY_LOG_PATH);
+#endif
+
+    BootProfiler::next("instantiateCommonItems");
     instantiateCommonItems();
+    BootProfiler::end();
 
 LV_LOG("Instantiation of common items complete.\n");
 
+    // Simulated sensors at production sample rates, decimated to one value per display frame. They feed
+    // TheBrain's temperature and water level through the Telemetry store.
+    SensorSim* sensors = new SensorSim();
+    // Rate in Hz, then the SensorModel: start, noise, drift/s, step size, steps/s, low, high.
+    sensors->add("temperature",    1000,  { 62.0f, 1.5f,  0.8f,   6.0f, 0.05f,  55.0f, 105.0f }, Decimation::Average, 1);
+    sensors->add("fullPercentage",  100,  { 40.0f, 2.0f, -0.5f,  25.0f, 0.02f,   0.0f, 100.0f }, Decimation::Average, 2);
+    sensors->add("pumpPressure",  10000,  { 30.0f, 4.0f,  0.0f,  12.0f, 0.10f,   0.0f,  80.0f }, Decimation::MinMax, 3);
+    sensors->Start();
+
 //	hal_loop();
 // Final loop with the ability to add our own stuff in there.
+    uint32_t lastHeapReport = lv_tick_get();
+    uint32_t lastLatencyReport = lv_tick_get();
     while(1) {
         hal_delay();
         // If you're running task-based UI, you'll need this mutex and the associated UI tasks will be of type LockingRoboTask.
         LockingRoboTask::TakeMutex();
-        lv_task_handler();
+        {
+            HeapScope scope("renderer");
+            lv_task_handler();
+        }
         LockingRoboTask::GiveMutex();
 
+#if HEAP_SCOPES && HEAP_SCOPE_REPORT_MS
+        if (lv_tick_elaps(lastHeapReport) >= HEAP_SCOPE_REPORT_MS) {
+            lastHeapReport = lv_tick_get();
+            HeapScope::report();
+        }
+#endif
+#if INPUT_LATENCY_REPORT_MS
+        if (lv_tick_elaps(lastLatencyReport) >= INPUT_LATENCY_REPORT_MS) {
+            lastLatencyReport = lv_tick_get();
+            InputSampler::report();
+        }
+#endif
+
     // Can do other emulated work here.
     }
 }
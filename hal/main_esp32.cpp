@@ -40,11 +40,18 @@
 #include <Arduino.h>
 #include "TFT_eSPI.h"
 #include "Widgets.h"
+#include "HeapScope.h"
+#include "BootProfiler.h"
+#include "InputSampler.h"
 
 extern void instantiateCommonItems();
 
 TFT_eSPI tft = TFT_eSPI();
 
+// The display and the touch controller share one SPI bus. Flushes run on the LVGL task and touch reads on
+// the InputSampler task, so each holds this around its transfer.
+static SemaphoreHandle_t spiMutex = nullptr;
+
 LV_IMG_DECLARE(ON1);
 
 #if LV_USE_LOG
@@ -101,17 +108,22 @@ void displayFlush( lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
     uint32_t w = ( area->x2 - area->x1 + 1 );
     uint32_t h = ( area->y2 - area->y1 + 1 );
 
+    xSemaphoreTake(spiMutex, portMAX_DELAY);
     tft.startWrite();
     tft.setAddrWindow( area->x1, area->y1, w, h );
     tft.pushColors( ( uint16_t * )&color_p->full, w * h, true );
     tft.endWrite();
+    xSemaphoreGive(spiMutex);
 
     lv_disp_flush_ready( disp );
 }
 
+// Called by the InputSampler task, not by LVGL - see InputSampler.h.
 void touchscreen_read( lv_indev_drv_t * indev_driver, lv_indev_data_t * data ) {
   uint16_t touchX, touchY;
+  xSemaphoreTake(spiMutex, portMAX_DELAY);
   bool touched = tft.getTouch( &touchX, &touchY, 600);
+  xSemaphoreGive(spiMutex);
   if( !touched )
   {
       data->state = LV_INDEV_STATE_REL;
@@ -140,6 +152,8 @@ void lvSetup(){
 
   */
   lv_init();
+  spiMutex = xSemaphoreCreateMutex();
+  assert(spiMutex);
 
   #if LV_USE_LOG != 0
     lv_log_register_print_cb( my_print ); /* register print function for debugging */
@@ -182,6 +196,10 @@ void lvSetup(){
   indev_drv.read_cb = touchscreen_read;      /*Set your driver function*/
   lv_indev_drv_register(&indev_drv);         /*Finally register the driver*/
 
+  // Touch is read on its own task every INPUT_SAMPLE_PERIOD_MS and queued for LVGL. It starts once the
+  // panel is up (setup()). This has to come before BootProfiler::watchFirstFrame().
+  InputSampler::attach();
+
   /*
 
   Setup del tema
@@ -220,20 +238,27 @@ public:
     Start();
   };
   void Run() {
+    HeapScope scope("renderer");
     lv_task_handler();
   };
 };
 
 static LVTaskHandler *plvTask=nullptr;
 
-void mySetup() {
-  blinkLED_GPIO2(1, 500);
-
-  Serial.begin(115200);
-  while (!Serial)
-    ;
+// The boot blinks add 2.8 seconds to the first frame. Turn them on when you need to see that the chip booted.
+#ifndef BOOT_BLINK_LED
+#define BOOT_BLINK_LED 0
+#endif
 
+//
+// Display and touch bring-up. Nothing in here touches LVGL, so it runs as an InitJob while the
+// widgets are being constructed.
+//
+void hardwareSetup() {
+#if BOOT_BLINK_LED
+  blinkLED_GPIO2(1, 500);
   blinkLED_GPIO2(3, 300);
+#endif
 
   tft.begin();
   tft.setRotation(MMB_ROTATION);
@@ -259,25 +284,42 @@ RecalibrateTouchScreen();
 
   tft.setTouch(calData);
 #endif
-  /*
-
-  lvgl setup
- 
-  */
-  lvSetup();
-  
 }
 
 void setup() {
-  mySetup();
+  Serial.begin(115200);
+  while (!Serial)
+    ;
+
+  // LVGL and its drivers only - registering the display doesn't touch the panel yet.
+  BootProfiler::begin("lvSetup");
+  lvSetup();
+  BootProfiler::end();
+  BootProfiler::watchFirstFrame();
+
+  {
+    InitJob hardware("hardware", hardwareSetup);
 
 LV_LOG("Starting Widgets Instantiation.\n");
-  instantiateWidgets();
+    BootProfiler::begin("instantiateWidgets");
+    instantiateWidgets();
+    BootProfiler::end();
 LV_LOG("Instantiation of widgets complete.\n");
-    /* Initialize your hardware. */
+
+    BootProfiler::begin("instantiateCommonItems");
     instantiateCommonItems();
+    BootProfiler::end();
 LV_LOG("Instantiation of common items complete.\n");
 
+    // Nothing is flushed before the LVGL task starts, and that needs the panel up.
+    BootProfiler::begin("wait for hardware");
+    hardware.wait();
+    BootProfiler::end();
+  }
+
+  if (InputSampler::get())
+    InputSampler::get()->Start();
+
   plvTask = new LVTaskHandler();
   assert(plvTask);
 
@@ -290,4 +332,24 @@ void loop() {
 // - now handled by plvTask -    
 //  lv_task_handler();
 
+#if HEAP_SCOPES && HEAP_SCOPE_REPORT_MS
+  static unsigned long lastHeapReport = 0;
+  if (millis() - lastHeapReport >= HEAP_SCOPE_REPORT_MS) {
+    lastHeapReport = millis();
+    HeapScope::report();
+  }
+#endif
+
+#if INPUT_LATENCY_REPORT_MS
+  static unsigned long lastLatencyReport = 0;
+  if (millis() - lastLatencyReport >= INPUT_LATENCY_REPORT_MS) {
+    lastLatencyReport = millis();
+    // The latencies are LVGL's side of the sampler, and LVTaskHandler runs LVGL on another task.
+    LockingRoboTask::TakeMutex();
+    InputSampler::report();
+    LockingRoboTask::GiveMutex();
+  }
+#endif
+  delay(100);
+
 }
@@ -0,0 +1,109 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BandPool.h"
+
+#ifndef ESP_PLATFORM
+
+BandPool::BandPool(uint8_t bands) {
+    job = Job{ nullptr, nullptr, 0, 0 };
+    generation = 0;
+    pending = 0;
+    stopping = false;
+
+    for (uint8_t i = 1; i < bands; i++)
+        workers.push_back(std::thread(&BandPool::workerLoop, this, i));
+}
+
+BandPool::~BandPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread& t : workers)
+        t.join();
+}
+
+void BandPool::runBand(const Job& j, uint8_t band) {
+    if (band >= j.bands)
+        return;
+
+    int32_t first = j.rows * band / j.bands;
+    int32_t next  = j.rows * (band + 1) / j.bands;
+    if (next > first)
+        j.fn(j.ctx, first, next - first);
+}
+
+void BandPool::workerLoop(uint8_t band) {
+    uint32_t seen = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+
+    while (true) {
+        wake.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping)
+            return;
+
+        seen = generation;
+        Job mine = job;
+        lock.unlock();
+
+        runBand(mine, band);
+
+        lock.lock();
+        if (--pending == 0)
+            done.notify_one();
+    }
+}
+
+void BandPool::run(int32_t rows, BandFn fn, void* ctx) {
+    uint8_t bands = getBands();
+    if (rows < bands)
+        bands = (uint8_t)rows;
+
+    if (bands <= 1 || workers.empty()) {
+        fn(ctx, 0, rows);
+        return;
+    }
+
+    Job mine = Job{ fn, ctx, rows, bands };
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        job = mine;
+        pending = (uint8_t)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    runBand(mine, 0);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    done.wait(lock, [&]() { return pending == 0; });
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#ifndef ESP_PLATFORM
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A small pool of worker threads which split a range of rows into horizontal bands.
+ * @details The calling thread always takes the first band itself, so a pool made for N bands
+ *          only owns N-1 threads. run() returns once every band is finished, so the bands can
+ *          write into disjoint parts of one buffer which is then used as a whole.
+ *          Native only - on the ESP32 the second core already belongs to the Arduino/WiFi tasks.
+ */
+class BandPool {
+public:
+    typedef void (*BandFn)(void* ctx, int32_t firstRow, int32_t rowCount);
+
+    BandPool(uint8_t bands);
+    ~BandPool();
+
+    uint8_t getBands() const { return (uint8_t)(workers.size() + 1); };
+
+    /**
+     * @brief Calls fn(ctx, first, count) for each band of [0, rows). Blocks until all bands are done.
+     */
+    void run(int32_t rows, BandFn fn, void* ctx);
+
+protected:
+    struct Job {
+        BandFn fn;
+        void* ctx;
+        int32_t rows;
+        uint8_t bands;
+    };
+
+    void workerLoop(uint8_t band);
+    static void runBand(const Job& job, uint8_t band);
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    Job job;
+    uint32_t generation;
+    uint8_t pending;
+    bool stopping;
+};
+#endif
@@ -0,0 +1,259 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BitmapCache.h"
+#include <algorithm>
+
+// How long a widget must be left alone after a change before it is rasterized again.
+static const uint32_t rebuildDelayMS = 300;
+
+static BitmapCacheStats totals = { 0, 0, 0, 0, BITMAP_CACHE_BUDGET };
+static std::vector<BitmapCache*> caches;
+static std::vector<lv_obj_t*> cacheSources;
+
+BitmapCache::BitmapCache(lv_obj_t* _source, bool _opaque) {
+    source = _source;
+    image = nullptr;
+    snapshot = nullptr;
+    timer = nullptr;
+    bytes = 0;
+    opaque = _opaque;
+    updating = false;
+    // Hidden objects can't be clicked, so clickable widgets stay in place but draw at opa 0.
+    hideSource = !lv_obj_has_flag(source, LV_OBJ_FLAG_CLICKABLE);
+
+    lv_obj_add_event_cb(source, sourceEvent, LV_EVENT_ALL, this);
+    // Layout usually isn't final yet when widgets are being created, so rasterize a little later.
+    scheduleBuild();
+}
+
+BitmapCache::~BitmapCache() {
+    if (timer)
+        lv_timer_del(timer);
+
+    release();
+
+    if (image)
+        lv_obj_del(image);
+    if (source)
+        lv_obj_remove_event_cb_with_user_data(source, sourceEvent, this);
+}
+
+void BitmapCache::build() {
+    if (snapshot || !source)
+        return;
+
+#if !LV_USE_SNAPSHOT
+    // Nothing to render the bitmap with - the widget keeps drawing itself.
+    totals.rejected++;
+    return;
+#else
+    const lv_img_cf_t cf = opaque ? LV_IMG_CF_TRUE_COLOR : LV_IMG_CF_TRUE_COLOR_ALPHA;
+    lv_obj_update_layout(source);
+
+    uint32_t needed = lv_snapshot_buf_size_needed(source, cf);
+    if (!needed || totals.bytesInUse + needed > totals.budget) {
+        totals.rejected++;
+        return;
+    }
+
+    snapshot = lv_snapshot_take(source, cf);
+    if (!snapshot) {
+        totals.rejected++;
+        return;
+    }
+    bytes = needed;
+    totals.bytesInUse += bytes;
+    totals.misses++;
+
+    updating = true;
+    if (!image) {
+        image = lv_img_create(lv_obj_get_parent(source));
+        lv_obj_clear_flag(image, LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_add_flag(image, LV_OBJ_FLAG_IGNORE_LAYOUT);
+        lv_obj_add_event_cb(image, imageEvent, LV_EVENT_ALL, this);
+    }
+    lv_img_set_src(image, snapshot);
+    lv_obj_clear_flag(image, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_to_index(image, lv_obj_get_index(source) + 1);
+
+    // The snapshot covers the widget's area grown by its extra draw size (shadows, outlines).
+    // Find out where (0,0) lands in the parent and shift the image onto that area.
+    lv_area_t area;
+    lv_area_t at;
+    lv_coord_t ext = _lv_obj_get_ext_draw_size(source);
+    lv_obj_get_coords(source, &area);
+    lv_obj_set_pos(image, 0, 0);
+    lv_obj_update_layout(image);
+    lv_obj_get_coords(image, &at);
+    lv_obj_set_pos(image, area.x1 - ext - at.x1, area.y1 - ext - at.y1);
+
+    if (hideSource)
+        lv_obj_add_flag(source, LV_OBJ_FLAG_HIDDEN);
+    else
+        lv_obj_set_style_opa(source, LV_OPA_TRANSP, 0);
+    updating = false;
+#endif
+}
+
+void BitmapCache::release() {
+    if (!snapshot)
+        return;
+
+    updating = true;
+    if (image) {
+        lv_obj_add_flag(image, LV_OBJ_FLAG_HIDDEN);
+        lv_img_set_src(image, NULL);
+    }
+    if (source) {
+        if (hideSource)
+            lv_obj_clear_flag(source, LV_OBJ_FLAG_HIDDEN);
+        else
+            lv_obj_remove_local_style_prop(source, LV_STYLE_OPA, 0);
+    }
+    updating = false;
+
+    lv_img_cache_invalidate_src(snapshot);
+#if LV_USE_SNAPSHOT
+    lv_snapshot_free(snapshot);
+#endif
+    snapshot = nullptr;
+    totals.bytesInUse -= bytes;
+    bytes = 0;
+}
+
+void BitmapCache::scheduleBuild() {
+    if (timer) {
+        lv_timer_reset(timer);
+        return;
+    }
+    timer = lv_timer_create(rebuildTimer, rebuildDelayMS, this);
+    lv_timer_set_repeat_count(timer, 1);
+}
+
+void BitmapCache::invalidate() {
+    release();
+    scheduleBuild();
+}
+
+void BitmapCache::rebuildTimer(lv_timer_t* t) {
+    BitmapCache* self = (BitmapCache*)t->user_data;
+    // A repeat count of 1 means LVGL deletes the timer once this returns.
+    self->timer = nullptr;
+    self->build();
+}
+
+void BitmapCache::sourceEvent(lv_event_t* e) {
+    BitmapCache* self = (BitmapCache*)lv_event_get_user_data(e);
+    if (self->updating)
+        return;
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_PRESSED:
+    case LV_EVENT_PRESS_LOST:
+    case LV_EVENT_RELEASED:
+    case LV_EVENT_VALUE_CHANGED:
+    case LV_EVENT_FOCUSED:
+    case LV_EVENT_DEFOCUSED:
+    case LV_EVENT_STYLE_CHANGED:
+    case LV_EVENT_SIZE_CHANGED:
+    case LV_EVENT_CHILD_CHANGED:
+        self->invalidate();
+        break;
+    case LV_EVENT_DELETE: {
+        // The widget is going away - so is this cache.
+        self->source = nullptr;
+        auto it = std::find(caches.begin(), caches.end(), self);
+        if (it != caches.end()) {
+            cacheSources.erase(cacheSources.begin() + (it - caches.begin()));
+            caches.erase(it);
+        }
+        delete self;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void BitmapCache::imageEvent(lv_event_t* e) {
+    BitmapCache* self = (BitmapCache*)lv_event_get_user_data(e);
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_DRAW_MAIN_BEGIN:
+        totals.hits++;
+        break;
+    case LV_EVENT_DELETE:
+        self->image = nullptr;
+        break;
+    default:
+        break;
+    }
+}
+
+void BitmapCache::setBudget(uint32_t bytes) {
+    totals.budget = bytes;
+}
+
+BitmapCacheStats BitmapCache::getStats() {
+    return totals;
+}
+
+void BitmapCache::resetStats() {
+    totals.hits = 0;
+    totals.misses = 0;
+    totals.rejected = 0;
+}
+
+////////////////////////////////////////
+//
+//  lvpp widget helpers
+//
+////////////////////////////////////////
+
+void cacheAsBitmap(lvppBase& widget, bool enable, bool opaque) {
+    lv_obj_t* obj = widget.getObj();
+    auto it = std::find(cacheSources.begin(), cacheSources.end(), obj);
+    bool found = it != cacheSources.end();
+
+    if (enable && !found) {
+        caches.push_back(new BitmapCache(obj, opaque));
+        cacheSources.push_back(obj);
+    }
+    else if (!enable && found) {
+        size_t index = it - cacheSources.begin();
+        delete caches[index];
+        caches.erase(caches.begin() + index);
+        cacheSources.erase(it);
+    }
+}
+
+void invalidateBitmapCache(lvppBase& widget) {
+    auto it = std::find(cacheSources.begin(), cacheSources.end(), widget.getObj());
+    if (it != cacheSources.end())
+        caches[it - cacheSources.begin()]->invalidate();
+}
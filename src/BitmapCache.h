@@ -0,0 +1,107 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <cstdint>
+#include <vector>
+
+#ifndef BITMAP_CACHE_BUDGET
+#ifdef ESP_PLATFORM
+#define BITMAP_CACHE_BUDGET (64U * 1024U)
+#else
+#define BITMAP_CACHE_BUDGET (1024U * 1024U)
+#endif
+#endif
+
+struct BitmapCacheStats {
+    uint32_t hits;          // times a cached bitmap was drawn instead of its widget subtree
+    uint32_t misses;        // times a subtree had to be rasterized into its bitmap
+    uint32_t rejected;      // rasterizations skipped because they would exceed the budget
+    uint32_t bytesInUse;
+    uint32_t budget;
+};
+
+/**
+ * @brief "Cache as bitmap" for a static widget subtree.
+ * @details The widget (and its children) are rendered once into an off-screen bitmap with lv_snapshot
+ *          (without LV_USE_SNAPSHOT every build is rejected and the widget draws itself as before).
+ *          An image object showing that bitmap sits just above the widget in z-order, and the widget
+ *          itself stops drawing: hidden if it isn't clickable, otherwise kept in place at opa 0 so it
+ *          still gets touches. Redraws of anything overlapping then cost a plain blit.
+ *
+ *          Presses, value/style/size changes and child changes drop the bitmap and show the live
+ *          widget again. The bitmap is re-rasterized once the widget has been quiet for a moment.
+ *          Programmatic changes which send no event (like lv_label_set_text) must call invalidate().
+ */
+class BitmapCache {
+public:
+    /**
+     * @param opaque Set when the subtree covers its whole area - the bitmap then skips the alpha channel.
+     */
+    BitmapCache(lv_obj_t* source, bool opaque);
+    ~BitmapCache();
+
+    /**
+     * @brief Drops the bitmap and schedules a fresh rasterization.
+     */
+    void invalidate();
+    bool isCached() const { return snapshot != nullptr; };
+
+    static void setBudget(uint32_t bytes);
+    static BitmapCacheStats getStats();
+    static void resetStats();
+
+protected:
+    void build();
+    void release();
+    void scheduleBuild();
+
+    static void sourceEvent(lv_event_t* e);
+    static void imageEvent(lv_event_t* e);
+    static void rebuildTimer(lv_timer_t* t);
+
+    lv_obj_t* source;
+    lv_obj_t* image;
+    lv_img_dsc_t* snapshot;
+    lv_timer_t* timer;
+    uint32_t bytes;
+    bool opaque;
+    bool hideSource;
+    bool updating;      // set while this class itself changes the source, so its events are ignored
+};
+
+/**
+ * @brief Turns "cache as bitmap" on or off for any lvpp widget.
+ */
+void cacheAsBitmap(lvppBase& widget, bool enable = true, bool opaque = false);
+
+/**
+ * @brief Tells the cache of an lvpp widget (if it has one) that its content changed.
+ */
+void invalidateBitmapCache(lvppBase& widget);
@@ -0,0 +1,189 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "BootProfiler.h"
+#include <atomic>
+#include <cstdio>
+#ifndef ESP_PLATFORM
+#include <chrono>
+#endif
+
+static BootPhaseRecord phases[BOOT_PROFILER_MAX_PHASES];
+static std::atomic<uint8_t> phaseCount(0);
+static uint32_t firstFrame = 0;
+static void (*prevMonitor)(lv_disp_drv_t*, uint32_t, uint32_t) = nullptr;
+
+// Per thread: which track it is and which phases it has open.
+static thread_local const char* track = "main";
+static thread_local int8_t openPhases[BOOT_PROFILER_MAX_DEPTH];   // -1 = not recorded (table full)
+static thread_local uint8_t depth = 0;
+static thread_local uint8_t tooDeep = 0;                           // begin() calls past the max depth
+
+#ifndef ESP_PLATFORM
+// Initialized before main(), which is as close to process start as we get.
+static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+#endif
+
+uint32_t BootProfiler::nowUS() {
+#ifdef ESP_PLATFORM
+    return micros();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - processStart).count();
+#endif
+}
+
+void BootProfiler::begin(const char* name) {
+    if (depth >= BOOT_PROFILER_MAX_DEPTH) {
+        tooDeep++;
+        return;
+    }
+    uint8_t i = phaseCount.fetch_add(1);
+    if (i >= BOOT_PROFILER_MAX_PHASES) {
+        phaseCount.store(BOOT_PROFILER_MAX_PHASES);
+        openPhases[depth++] = -1;
+        return;
+    }
+
+    BootPhaseRecord& r = phases[i];
+    r.name = name;
+    r.track = track;
+    r.depth = depth;
+    r.endUS = 0;
+    r.startUS = nowUS();
+    openPhases[depth++] = i;
+}
+
+void BootProfiler::end() {
+    if (tooDeep) {
+        tooDeep--;
+        return;
+    }
+    if (!depth)
+        return;
+    int8_t i = openPhases[--depth];
+    if (i >= 0)
+        phases[i].endUS = nowUS();
+}
+
+void BootProfiler::next(const char* name) {
+    end();
+    begin(name);
+}
+
+static void firstFrameMonitor(lv_disp_drv_t* drv, uint32_t time, uint32_t px) {
+    firstFrame = BootProfiler::nowUS();
+    drv->monitor_cb = prevMonitor;
+    if (prevMonitor)
+        prevMonitor(drv, time, px);
+#if BOOT_PROFILER_REPORT
+    BootProfiler::report();
+#endif
+}
+
+void BootProfiler::watchFirstFrame(lv_disp_t* disp) {
+    if (!disp)
+        disp = lv_disp_get_default();
+    if (!disp || firstFrame)
+        return;
+    prevMonitor = disp->driver->monitor_cb;
+    disp->driver->monitor_cb = firstFrameMonitor;
+}
+
+uint32_t BootProfiler::firstFrameUS() {
+    return firstFrame;
+}
+
+uint8_t BootProfiler::count() {
+    uint8_t n = phaseCount.load();
+    return n < BOOT_PROFILER_MAX_PHASES ? n : BOOT_PROFILER_MAX_PHASES;
+}
+
+const BootPhaseRecord* BootProfiler::getPhase(uint8_t index) {
+    return index < count() ? &phases[index] : nullptr;
+}
+
+void BootProfiler::report() {
+    printf("Boot profile (ms)        track       start   duration\n");
+    for (uint8_t i = 0; i < count(); i++) {
+        const BootPhaseRecord& r = phases[i];
+        char name[32];
+        snprintf(name, sizeof(name), "%*s%s", r.depth * 2, "", r.name);
+        if (r.endUS)
+            printf("  %-22s %-10s %7.1f %10.1f\n", name, r.track, r.startUS / 1000.0, (r.endUS - r.startUS) / 1000.0);
+        else
+            printf("  %-22s %-10s %7.1f    running\n", name, r.track, r.startUS / 1000.0);
+    }
+    if (firstFrame)
+        printf("  %-22s %-10s %7.1f\n", "first frame", "", firstFrame / 1000.0);
+}
+
+////////////////////////////////////////
+//
+//  I n i t J o b
+//
+////////////////////////////////////////
+
+InitJob::InitJob(const char* _name, std::function<void()> _fn, uint32_t stackSize) : name(_name), fn(_fn), waited(false) {
+#ifdef ESP_PLATFORM
+    done = xSemaphoreCreateBinary();
+    xTaskCreate(&InitJob::runner, name, stackSize, this, 1, nullptr);
+#else
+    (void)stackSize;
+    thread = std::thread(&InitJob::runner, this);
+#endif
+}
+
+InitJob::~InitJob() {
+    wait();
+#ifdef ESP_PLATFORM
+    vSemaphoreDelete(done);
+#endif
+}
+
+void InitJob::wait() {
+    if (waited)
+        return;
+    waited = true;
+#ifdef ESP_PLATFORM
+    xSemaphoreTake(done, portMAX_DELAY);
+#else
+    thread.join();
+#endif
+}
+
+void InitJob::runner(void* vjob) {
+    InitJob* job = (InitJob*)vjob;
+    track = job->name;
+    BootProfiler::begin(job->name);
+    job->fn();
+    BootProfiler::end();
+#ifdef ESP_PLATFORM
+    xSemaphoreGive(job->done);
+    vTaskDelete(nullptr);
+#endif
+}
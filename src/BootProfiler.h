@@ -0,0 +1,107 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <functional>
+#ifdef ESP_PLATFORM
+#include <Arduino.h>
+#else
+#include <thread>
+#endif
+
+#define BOOT_PROFILER_MAX_PHASES 48
+#define BOOT_PROFILER_MAX_DEPTH  4
+
+// Print the boot report as soon as the first frame has been flushed.
+#ifndef BOOT_PROFILER_REPORT
+#define BOOT_PROFILER_REPORT 1
+#endif
+
+struct BootPhaseRecord {
+    const char* name;
+    const char* track;      // thread the phase ran on - "main" or an InitJob name
+    uint8_t depth;
+    uint32_t startUS;       // since power-on (ESP32) or process start (native)
+    uint32_t endUS;         // 0 while still open
+};
+
+/**
+ * @brief Timestamps boot phases, from power-on to the first frame on the display.
+ * @details Phases nest: begin()/end() open and close a phase, next() closes the innermost one and opens
+ *          a sibling - handy for a run of widget constructions. Each thread (see InitJob) keeps its own
+ *          nesting, so parallel phases show up side by side. Names must be string literals.
+ */
+class BootProfiler {
+public:
+    static uint32_t nowUS();
+
+    static void begin(const char* name);
+    static void next(const char* name);
+    static void end();
+
+    /**
+     * @brief Records the first frame LVGL renders on disp (default display) via its monitor_cb,
+     *        then puts the previous monitor_cb back.
+     */
+    static void watchFirstFrame(lv_disp_t* disp = nullptr);
+
+    /**
+     * @brief Time to first frame, or 0 until it has been drawn.
+     */
+    static uint32_t firstFrameUS();
+
+    static uint8_t count();
+    static const BootPhaseRecord* getPhase(uint8_t index);
+    static void report();
+};
+
+/**
+ * @brief One-shot init phase running on its own thread (a FreeRTOS task on the ESP32), profiled as its
+ *        own BootProfiler track. Use it for phases which don't touch LVGL, e.g. hardware bring-up while
+ *        the widgets are being constructed. The destructor waits for it too.
+ */
+class InitJob {
+public:
+    InitJob(const char* name, std::function<void()> fn, uint32_t stackSize = 4096);
+    ~InitJob();
+
+    void wait();
+
+protected:
+    static void runner(void* job);
+
+    const char* name;
+    std::function<void()> fn;
+    bool waited;
+#ifdef ESP_PLATFORM
+    SemaphoreHandle_t done;
+#else
+    std::thread thread;
+#endif
+};
@@ -0,0 +1,78 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "CanvasFormat.h"
+#include "BitmapCache.h"
+
+uint32_t canvasIndexedBytes(uint8_t bpp, lv_coord_t w, lv_coord_t h) {
+    switch (bpp) {
+    case 1:  return LV_CANVAS_BUF_SIZE_INDEXED_1BIT(w, h);
+    case 2:  return LV_CANVAS_BUF_SIZE_INDEXED_2BIT(w, h);
+    case 4:  return LV_CANVAS_BUF_SIZE_INDEXED_4BIT(w, h);
+    default: return LV_CANVAS_BUF_SIZE_INDEXED_8BIT(w, h);
+    }
+}
+
+CanvasFormatChoice chooseCanvasFormat(lv_coord_t w, lv_coord_t h, uint16_t colors, uint32_t budgetBytes, bool preferSpeed) {
+    CanvasFormatChoice choice;
+    choice.indexedBpp = colors <= 2 ? 1 : colors <= 4 ? 2 : colors <= 16 ? 4 : 8;
+    choice.trueColor = false;
+    choice.bytes = canvasIndexedBytes(choice.indexedBpp, w, h);
+    if (!preferSpeed || choice.bytes >= budgetBytes)
+        return choice;
+
+    const uint32_t trueColorBytes = LV_CANVAS_BUF_SIZE_TRUE_COLOR(w, h);
+    BitmapCacheStats cache = BitmapCache::getStats();
+    if (choice.bytes + trueColorBytes <= budgetBytes && cache.bytesInUse + trueColorBytes <= cache.budget) {
+        choice.trueColor = true;
+        choice.bytes += trueColorBytes;
+        return choice;
+    }
+
+    const uint32_t eightBitBytes = canvasIndexedBytes(8, w, h);
+    if (choice.indexedBpp < 8 && eightBitBytes <= budgetBytes) {
+        choice.indexedBpp = 8;
+        choice.bytes = eightBitBytes;
+    }
+    return choice;
+}
+
+void applyCanvasFormat(lvppCanvasIndexed& canvas, const CanvasFormatChoice& choice, bool opaque) {
+    if (choice.trueColor)
+        cacheAsBitmap(canvas, true, opaque);
+}
+
+const char* canvasFormatName(const CanvasFormatChoice& choice) {
+    if (choice.trueColor)
+        return "true color";
+    switch (choice.indexedBpp) {
+    case 1:  return "indexed 1-bit";
+    case 2:  return "indexed 2-bit";
+    case 4:  return "indexed 4-bit";
+    default: return "indexed 8-bit";
+    }
+}
@@ -0,0 +1,74 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <cstdint>
+
+//
+// Color format selection for canvases. Indexed canvases cost w*h*bpp/8 bytes but every blit decodes
+// each pixel through the palette; a true-color copy blits straight from memory at w*h*2 bytes. Which is
+// right depends on the device, so declare a byte budget (per SKU via -D) and let the chooser decide.
+// Measure the actual blit cost per format on a device with './bench.sh canvas'.
+//
+
+// Byte budget for the main screen background canvas.
+#ifndef BG_CANVAS_BUDGET
+#ifdef ESP_PLATFORM
+#define BG_CANVAS_BUDGET (48U * 1024U)
+#else
+#define BG_CANVAS_BUDGET (512U * 1024U)
+#endif
+#endif
+
+struct CanvasFormatChoice {
+    uint8_t indexedBpp;     // 1, 2, 4 or 8 - what to construct the lvppCanvasIndexed with
+    bool trueColor;         // also keep a true-color copy to blit from (see cacheAsBitmap)
+    uint32_t bytes;         // total RAM for the choice
+};
+
+/**
+ * @brief Bytes for an indexed canvas of the given depth, palette included.
+ */
+uint32_t canvasIndexedBytes(uint8_t bpp, lv_coord_t w, lv_coord_t h);
+
+/**
+ * @brief Picks the format for a canvas drawn with at most 'colors' distinct colors.
+ * @details The smallest indexed depth holding 'colors' is the baseline. With preferSpeed, spare budget
+ *          buys the faster options: a true-color copy first (if the bitmap cache budget has room too),
+ *          then 8-bit indexing, whose palette lookup is byte-aligned. Without it the baseline is kept.
+ *          If not even the baseline fits, the baseline is returned anyway.
+ */
+CanvasFormatChoice chooseCanvasFormat(lv_coord_t w, lv_coord_t h, uint16_t colors, uint32_t budgetBytes, bool preferSpeed = true);
+
+/**
+ * @brief Applies the true-color part of a choice once the canvas is fully drawn.
+ */
+void applyCanvasFormat(lvppCanvasIndexed& canvas, const CanvasFormatChoice& choice, bool opaque = true);
+
+const char* canvasFormatName(const CanvasFormatChoice& choice);
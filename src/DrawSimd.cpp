@@ -0,0 +1,522 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "DrawSimd.h"
+#include "BandPool.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DRAW_SIMD_X86 1
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DRAW_SIMD_NEON 1
+#endif
+
+// Only plain RGB565 buffers are handled. Byte-swapped 565 (LV_COLOR_16_SWAP) and other depths use LVGL as-is.
+// So does LV_COLOR_MIX_ROUND_OFS 0 (LVGL's built-in default), where lv_color_mix() takes a different,
+// truncating 565 path the kernels don't reproduce.
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0 && LV_COLOR_MIX_ROUND_OFS == 128
+#define DRAW_SIMD_SUPPORTED 1
+#else
+#define DRAW_SIMD_SUPPORTED 0
+#endif
+
+//
+// The mixing math matches lv_color_mix() with LV_COLOR_MIX_ROUND_OFS 128 exactly:
+//   channel = (fg * opa + bg * (255 - opa) + 128) / 255
+// Every intermediate fits in 16 bits (63 * 255 + 128 = 16193), so 8 (SSE2/NEON) or 16 (AVX2) pixels
+// are mixed per instruction. The divide uses (x + 1 + (x >> 8)) >> 8 which is exact for x < 65535.
+//
+
+typedef void (*fillRowFn)(uint16_t* dst, uint32_t len, uint16_t color);
+typedef void (*blendColorRowFn)(uint16_t* dst, uint32_t len, uint16_t color, uint8_t opa);
+typedef void (*blendMapRowFn)(uint16_t* dst, const uint16_t* src, uint32_t len, uint8_t opa);
+
+struct SimdKernels {
+    fillRowFn       fill;
+    blendColorRowFn blendColor;
+    blendMapRowFn   blendMap;
+};
+
+// Everything a range of rows needs, so bands can be handed to worker threads.
+struct BlendJob {
+    uint16_t* dest;
+    lv_coord_t destStride;
+    const uint16_t* src;
+    lv_coord_t srcStride;
+    uint32_t width;
+    uint16_t color;
+    lv_opa_t opa;
+    SimdKernels k;
+};
+
+static void (*stockBlend)(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc) = nullptr;
+static DrawSimdStats stats = { 0, 0, 0 };
+static bool levelSet = false;
+static SimdLevel activeLevel = SimdLevel::None;
+
+#ifndef ESP_PLATFORM
+static BandPool* bandPool = nullptr;
+static uint32_t bandMinPixels = 0;
+#endif
+
+////////////////////////////////////////
+//
+//  Scalar kernels - also used for the tails of the vector loops
+//
+////////////////////////////////////////
+
+static inline uint16_t div255(uint32_t x) {
+    return (uint16_t)((x + 1 + (x >> 8)) >> 8);
+}
+
+static void fillRowScalar(uint16_t* dst, uint32_t len, uint16_t color) {
+    for (uint32_t i = 0; i < len; i++)
+        dst[i] = color;
+}
+
+static void blendColorRowScalar(uint16_t* dst, uint32_t len, uint16_t color, uint8_t opa) {
+    const uint32_t inv = 255 - opa;
+    // Foreground is constant so premultiply it once, rounding offset included.
+    const uint32_t pr = (color >> 11) * opa + 128;
+    const uint32_t pg = ((color >> 5) & 0x3F) * opa + 128;
+    const uint32_t pb = (color & 0x1F) * opa + 128;
+
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t d = dst[i];
+        dst[i] = (div255(pr + (d >> 11) * inv) << 11) |
+                 (div255(pg + ((d >> 5) & 0x3F) * inv) << 5) |
+                  div255(pb + (d & 0x1F) * inv);
+    }
+}
+
+static void blendMapRowScalar(uint16_t* dst, const uint16_t* src, uint32_t len, uint8_t opa) {
+    const uint32_t inv = 255 - opa;
+
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t d = dst[i];
+        uint16_t s = src[i];
+        dst[i] = (div255((s >> 11) * opa + (d >> 11) * inv + 128) << 11) |
+                 (div255(((s >> 5) & 0x3F) * opa + ((d >> 5) & 0x3F) * inv + 128) << 5) |
+                  div255((s & 0x1F) * opa + (d & 0x1F) * inv + 128);
+    }
+}
+
+#if DRAW_SIMD_X86
+////////////////////////////////////////
+//
+//  SSE2 kernels - 8 pixels per step
+//
+////////////////////////////////////////
+
+__attribute__((target("sse2")))
+static inline __m128i div255SSE2(__m128i x) {
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+static void fillRowSSE2(uint16_t* dst, uint32_t len, uint16_t color) {
+    const __m128i c = _mm_set1_epi16((short)color);
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+    fillRowScalar(dst + i, len - i, color);
+}
+
+__attribute__((target("sse2")))
+static void blendColorRowSSE2(uint16_t* dst, uint32_t len, uint16_t color, uint8_t opa) {
+    const __m128i inv = _mm_set1_epi16(255 - opa);
+    const __m128i pr  = _mm_set1_epi16((short)((color >> 11) * opa + 128));
+    const __m128i pg  = _mm_set1_epi16((short)(((color >> 5) & 0x3F) * opa + 128));
+    const __m128i pb  = _mm_set1_epi16((short)((color & 0x1F) * opa + 128));
+    const __m128i m6  = _mm_set1_epi16(0x3F);
+    const __m128i m5  = _mm_set1_epi16(0x1F);
+
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i r = _mm_srli_epi16(d, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(d, 5), m6);
+        __m128i b = _mm_and_si128(d, m5);
+
+        r = div255SSE2(_mm_add_epi16(_mm_mullo_epi16(r, inv), pr));
+        g = div255SSE2(_mm_add_epi16(_mm_mullo_epi16(g, inv), pg));
+        b = div255SSE2(_mm_add_epi16(_mm_mullo_epi16(b, inv), pb));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b));
+    }
+    blendColorRowScalar(dst + i, len - i, color, opa);
+}
+
+__attribute__((target("sse2")))
+static void blendMapRowSSE2(uint16_t* dst, const uint16_t* src, uint32_t len, uint8_t opa) {
+    const __m128i vopa = _mm_set1_epi16(opa);
+    const __m128i inv  = _mm_set1_epi16(255 - opa);
+    const __m128i rnd  = _mm_set1_epi16(128);
+    const __m128i m6   = _mm_set1_epi16(0x3F);
+    const __m128i m5   = _mm_set1_epi16(0x1F);
+
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+
+        __m128i r = _mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(s, 11), vopa), _mm_mullo_epi16(_mm_srli_epi16(d, 11), inv));
+        __m128i g = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), m6), vopa),
+                                  _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(d, 5), m6), inv));
+        __m128i b = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(s, m5), vopa), _mm_mullo_epi16(_mm_and_si128(d, m5), inv));
+
+        r = div255SSE2(_mm_add_epi16(r, rnd));
+        g = div255SSE2(_mm_add_epi16(g, rnd));
+        b = div255SSE2(_mm_add_epi16(b, rnd));
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b));
+    }
+    blendMapRowScalar(dst + i, src + i, len - i, opa);
+}
+
+////////////////////////////////////////
+//
+//  AVX2 kernels - 16 pixels per step
+//
+////////////////////////////////////////
+
+__attribute__((target("avx2")))
+static inline __m256i div255AVX2(__m256i x) {
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+static void fillRowAVX2(uint16_t* dst, uint32_t len, uint16_t color) {
+    const __m256i c = _mm256_set1_epi16((short)color);
+    uint32_t i = 0;
+    for (; i + 16 <= len; i += 16)
+        _mm256_storeu_si256((__m256i*)(dst + i), c);
+    fillRowSSE2(dst + i, len - i, color);
+}
+
+__attribute__((target("avx2")))
+static void blendColorRowAVX2(uint16_t* dst, uint32_t len, uint16_t color, uint8_t opa) {
+    const __m256i inv = _mm256_set1_epi16(255 - opa);
+    const __m256i pr  = _mm256_set1_epi16((short)((color >> 11) * opa + 128));
+    const __m256i pg  = _mm256_set1_epi16((short)(((color >> 5) & 0x3F) * opa + 128));
+    const __m256i pb  = _mm256_set1_epi16((short)((color & 0x1F) * opa + 128));
+    const __m256i m6  = _mm256_set1_epi16(0x3F);
+    const __m256i m5  = _mm256_set1_epi16(0x1F);
+
+    uint32_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i r = _mm256_srli_epi16(d, 11);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(d, 5), m6);
+        __m256i b = _mm256_and_si256(d, m5);
+
+        r = div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(r, inv), pr));
+        g = div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(g, inv), pg));
+        b = div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(b, inv), pb));
+
+        _mm256_storeu_si256((__m256i*)(dst + i),
+                            _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b));
+    }
+    blendColorRowSSE2(dst + i, len - i, color, opa);
+}
+
+__attribute__((target("avx2")))
+static void blendMapRowAVX2(uint16_t* dst, const uint16_t* src, uint32_t len, uint8_t opa) {
+    const __m256i vopa = _mm256_set1_epi16(opa);
+    const __m256i inv  = _mm256_set1_epi16(255 - opa);
+    const __m256i rnd  = _mm256_set1_epi16(128);
+    const __m256i m6   = _mm256_set1_epi16(0x3F);
+    const __m256i m5   = _mm256_set1_epi16(0x1F);
+
+    uint32_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+
+        __m256i r = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_srli_epi16(s, 11), vopa),
+                                     _mm256_mullo_epi16(_mm256_srli_epi16(d, 11), inv));
+        __m256i g = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi16(s, 5), m6), vopa),
+                                     _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi16(d, 5), m6), inv));
+        __m256i b = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(s, m5), vopa),
+                                     _mm256_mullo_epi16(_mm256_and_si256(d, m5), inv));
+
+        r = div255AVX2(_mm256_add_epi16(r, rnd));
+        g = div255AVX2(_mm256_add_epi16(g, rnd));
+        b = div255AVX2(_mm256_add_epi16(b, rnd));
+
+        _mm256_storeu_si256((__m256i*)(dst + i),
+                            _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b));
+    }
+    blendMapRowSSE2(dst + i, src + i, len - i, opa);
+}
+#endif  // DRAW_SIMD_X86
+
+#if DRAW_SIMD_NEON
+////////////////////////////////////////
+//
+//  NEON kernels - 8 pixels per step
+//
+////////////////////////////////////////
+
+static inline uint16x8_t div255NEON(uint16x8_t x) {
+    return vshrq_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static void fillRowNEON(uint16_t* dst, uint32_t len, uint16_t color) {
+    const uint16x8_t c = vdupq_n_u16(color);
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+        vst1q_u16(dst + i, c);
+    fillRowScalar(dst + i, len - i, color);
+}
+
+static void blendColorRowNEON(uint16_t* dst, uint32_t len, uint16_t color, uint8_t opa) {
+    const uint16x8_t inv = vdupq_n_u16(255 - opa);
+    const uint16x8_t pr  = vdupq_n_u16((uint16_t)((color >> 11) * opa + 128));
+    const uint16x8_t pg  = vdupq_n_u16((uint16_t)(((color >> 5) & 0x3F) * opa + 128));
+    const uint16x8_t pb  = vdupq_n_u16((uint16_t)((color & 0x1F) * opa + 128));
+    const uint16x8_t m6  = vdupq_n_u16(0x3F);
+    const uint16x8_t m5  = vdupq_n_u16(0x1F);
+
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint16x8_t d = vld1q_u16(dst + i);
+        // vmlaq_u16(a, b, c) is a + b * c
+        uint16x8_t r = div255NEON(vmlaq_u16(pr, vshrq_n_u16(d, 11), inv));
+        uint16x8_t g = div255NEON(vmlaq_u16(pg, vandq_u16(vshrq_n_u16(d, 5), m6), inv));
+        uint16x8_t b = div255NEON(vmlaq_u16(pb, vandq_u16(d, m5), inv));
+
+        vst1q_u16(dst + i, vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b));
+    }
+    blendColorRowScalar(dst + i, len - i, color, opa);
+}
+
+static void blendMapRowNEON(uint16_t* dst, const uint16_t* src, uint32_t len, uint8_t opa) {
+    const uint16x8_t vopa = vdupq_n_u16(opa);
+    const uint16x8_t inv  = vdupq_n_u16(255 - opa);
+    const uint16x8_t rnd  = vdupq_n_u16(128);
+    const uint16x8_t m6   = vdupq_n_u16(0x3F);
+    const uint16x8_t m5   = vdupq_n_u16(0x1F);
+
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint16x8_t d = vld1q_u16(dst + i);
+        uint16x8_t s = vld1q_u16(src + i);
+
+        uint16x8_t r = vmlaq_u16(vmlaq_u16(rnd, vshrq_n_u16(s, 11), vopa), vshrq_n_u16(d, 11), inv);
+        uint16x8_t g = vmlaq_u16(vmlaq_u16(rnd, vandq_u16(vshrq_n_u16(s, 5), m6), vopa), vandq_u16(vshrq_n_u16(d, 5), m6), inv);
+        uint16x8_t b = vmlaq_u16(vmlaq_u16(rnd, vandq_u16(s, m5), vopa), vandq_u16(d, m5), inv);
+
+        vst1q_u16(dst + i, vorrq_u16(vorrq_u16(vshlq_n_u16(div255NEON(r), 11), vshlq_n_u16(div255NEON(g), 5)), div255NEON(b)));
+    }
+    blendMapRowScalar(dst + i, src + i, len - i, opa);
+}
+#endif  // DRAW_SIMD_NEON
+
+////////////////////////////////////////
+//
+//  Dispatch
+//
+////////////////////////////////////////
+
+SimdLevel drawSimdDetect() {
+#if DRAW_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::SSE2;
+#elif DRAW_SIMD_NEON
+    return SimdLevel::NEON;
+#endif
+    return SimdLevel::None;
+}
+
+void drawSimdSetLevel(SimdLevel level) {
+    SimdLevel best = drawSimdDetect();
+    // NEON and the x86 levels never coexist so a plain compare is enough to clamp.
+    activeLevel = (uint8_t)level > (uint8_t)best ? best : level;
+    levelSet = true;
+}
+
+SimdLevel drawSimdGetLevel() {
+    if (!levelSet)
+        drawSimdSetLevel(drawSimdDetect());
+    return activeLevel;
+}
+
+const char* drawSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE2:   return "SSE2";
+    case SimdLevel::AVX2:   return "AVX2";
+    case SimdLevel::NEON:   return "NEON";
+    default:                return "scalar";
+    }
+}
+
+static SimdKernels getKernels() {
+    switch (drawSimdGetLevel()) {
+#if DRAW_SIMD_X86
+    case SimdLevel::AVX2:   return SimdKernels{ fillRowAVX2, blendColorRowAVX2, blendMapRowAVX2 };
+    case SimdLevel::SSE2:   return SimdKernels{ fillRowSSE2, blendColorRowSSE2, blendMapRowSSE2 };
+#endif
+#if DRAW_SIMD_NEON
+    case SimdLevel::NEON:   return SimdKernels{ fillRowNEON, blendColorRowNEON, blendMapRowNEON };
+#endif
+    default:                return SimdKernels{ fillRowScalar, blendColorRowScalar, blendMapRowScalar };
+    }
+}
+
+DrawSimdStats drawSimdGetStats() {
+    return stats;
+}
+
+static void blendRows(void* ctx, int32_t firstRow, int32_t rowCount) {
+    const BlendJob& job = *(const BlendJob*)ctx;
+    uint16_t* dest = job.dest + job.destStride * firstRow;
+
+    if (!job.src) {
+        for (int32_t y = 0; y < rowCount; y++, dest += job.destStride) {
+            if (job.opa >= LV_OPA_MAX)
+                job.k.fill(dest, job.width, job.color);
+            else
+                job.k.blendColor(dest, job.width, job.color, job.opa);
+        }
+    }
+    else {
+        const uint16_t* src = job.src + job.srcStride * firstRow;
+        for (int32_t y = 0; y < rowCount; y++, dest += job.destStride, src += job.srcStride) {
+            if (job.opa >= LV_OPA_MAX)
+                memcpy(dest, src, job.width * sizeof(uint16_t));
+            else
+                job.k.blendMap(dest, src, job.width, job.opa);
+        }
+    }
+}
+
+void drawSimdBlend(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc) {
+    void (*fallback)(lv_draw_ctx_t*, const lv_draw_sw_blend_dsc_t*) = stockBlend ? stockBlend : lv_draw_sw_blend_basic;
+
+#if DRAW_SIMD_SUPPORTED
+    if (dsc->mask_buf && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP)
+        return;
+
+    // Partially masked pixels (anti-aliased edges, rounded corners, glyphs) stay with LVGL.
+    bool masked = dsc->mask_buf && dsc->mask_res != LV_DRAW_MASK_RES_FULL_COVER;
+    lv_disp_t* disp = _lv_refr_get_disp_refreshing();
+
+    if (masked || dsc->blend_mode != LV_BLEND_MODE_NORMAL || !disp ||
+        disp->driver->set_px_cb || disp->driver->screen_transp) {
+        stats.fallback++;
+        fallback(draw_ctx, dsc);
+        return;
+    }
+
+    if (dsc->opa <= LV_OPA_MIN)
+        return;
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area))
+        return;
+
+    stats.accelerated++;
+
+    const lv_coord_t destStride = lv_area_get_width(draw_ctx->buf_area);
+    const lv_coord_t h = lv_area_get_height(&blend_area);
+
+    BlendJob job;
+    job.dest = (uint16_t*)draw_ctx->buf + destStride * (blend_area.y1 - draw_ctx->buf_area->y1)
+                                        + (blend_area.x1 - draw_ctx->buf_area->x1);
+    job.destStride = destStride;
+    job.src = nullptr;
+    job.srcStride = 0;
+    job.width = lv_area_get_width(&blend_area);
+    job.color = dsc->color.full;
+    job.opa = dsc->opa;
+    job.k = getKernels();
+
+    if (dsc->src_buf) {
+        job.srcStride = lv_area_get_width(dsc->blend_area);
+        job.src = (const uint16_t*)dsc->src_buf + job.srcStride * (blend_area.y1 - dsc->blend_area->y1)
+                                                + (blend_area.x1 - dsc->blend_area->x1);
+    }
+
+#ifndef ESP_PLATFORM
+    if (bandPool && job.width * h >= bandMinPixels) {
+        stats.banded++;
+        bandPool->run(h, blendRows, &job);
+        return;
+    }
+#endif
+    blendRows(&job, 0, h);
+#else
+    stats.fallback++;
+    fallback(draw_ctx, dsc);
+#endif
+}
+
+bool drawSimdInstall(lv_disp_t* disp) {
+#if DRAW_SIMD_SUPPORTED
+    if (!disp)
+        disp = lv_disp_get_default();
+    if (!disp || !disp->driver->draw_ctx)
+        return false;
+
+    lv_draw_sw_ctx_t* swCtx = (lv_draw_sw_ctx_t*)disp->driver->draw_ctx;
+    if (swCtx->blend == drawSimdBlend)
+        return true;
+
+    stockBlend = swCtx->blend;
+    swCtx->blend = drawSimdBlend;
+    drawSimdGetLevel();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void drawSimdSetBandThreads(uint8_t threads, uint32_t minPixels) {
+#ifndef ESP_PLATFORM
+    // Called between frames with the LVGL mutex held, so no blend can be using the old pool.
+    delete bandPool;
+    bandPool = nullptr;
+    bandMinPixels = minPixels;
+
+    if (threads > 1)
+        bandPool = new BandPool(threads);
+#endif
+}
+
+uint8_t drawSimdGetBandThreads() {
+#ifndef ESP_PLATFORM
+    return bandPool ? bandPool->getBands() : 1;
+#else
+    return 1;
+#endif
+}
@@ -0,0 +1,91 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <cstdint>
+
+//
+// SIMD replacement for LVGL's software blend step (lv_draw_sw_blend_basic) on RGB565 draw buffers.
+// Solid fills, opacity fills (gradients arrive here one line at a time), opacity image blends and
+// plain image copies are handled with SSE2/AVX2 on x86 and NEON on ARM. Anything else - masks,
+// non-normal blend modes, set_px_cb displays, transparent screens - goes to the stock function.
+// Results are bit-identical to the stock renderer. That needs LV_COLOR_MIX_ROUND_OFS 128 (lv_conf.h, and
+// the emulator flags in platformio.ini); with any other rounding every blend goes to the stock function.
+//
+
+enum class SimdLevel : uint8_t {
+    None,       // Plain C++ kernels - still avoids the per-pixel lv_color_mix() calls.
+    SSE2,
+    AVX2,
+    NEON
+};
+
+struct DrawSimdStats {
+    uint32_t accelerated;   // blend calls handled here
+    uint32_t fallback;      // blend calls passed on to LVGL
+    uint32_t banded;        // accelerated calls which were split across band threads
+};
+
+/**
+ * @brief Replaces the blend callback of the display's software draw context.
+ * @param disp Display to accelerate. nullptr means the default display.
+ * @return false if the build isn't RGB565 with LV_COLOR_MIX_ROUND_OFS 128, or the display has no software
+ *         draw context.
+ */
+bool drawSimdInstall(lv_disp_t* disp = nullptr);
+
+/**
+ * @brief Best instruction set this CPU supports (detected once at runtime).
+ */
+SimdLevel drawSimdDetect();
+
+/**
+ * @brief Restricts the kernels to a lower level - used by the microbenchmark. Clamped to drawSimdDetect().
+ */
+void drawSimdSetLevel(SimdLevel level);
+SimdLevel drawSimdGetLevel();
+const char* drawSimdLevelName(SimdLevel level);
+
+DrawSimdStats drawSimdGetStats();
+
+/**
+ * @brief Optional band render mode (native only). Blends covering at least minPixels are split into
+ *        horizontal bands and rasterized in parallel on 'threads' threads (the caller is one of them).
+ *        The bands are disjoint rows of the draw buffer and all finish before the blend returns, so
+ *        LVGL flushes the area as one piece. threads <= 1 turns the mode off.
+ * @note  Full-screen redraws like screen transitions are mostly large fills and image blends, which is
+ *        where this pays off. LVGL itself still walks the widget tree on one thread.
+ */
+void drawSimdSetBandThreads(uint8_t threads, uint32_t minPixels = 16384);
+uint8_t drawSimdGetBandThreads();
+
+/**
+ * @brief The blend callback itself. Exposed so the microbenchmark can call it against the stock one.
+ */
+void drawSimdBlend(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc);
@@ -0,0 +1,75 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Text in a fixed inline buffer of N bytes (terminator included), set with printf-style formatting.
+ * @details Nothing is allocated, and every setter reports whether the text actually changed, so the caller
+ *          can skip relayout and invalidation when it didn't. Longer text is truncated.
+ */
+template <size_t N>
+class FixedText {
+public:
+    FixedText() { text[0] = '\0'; };
+
+    /**
+     * @return true if the text is now different from before.
+     */
+    bool format(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        bool changed = vformat(fmt, args);
+        va_end(args);
+        return changed;
+    };
+
+    bool vformat(const char* fmt, va_list args) {
+        char scratch[N];
+        vsnprintf(scratch, N, fmt, args);
+        return set(scratch);
+    };
+
+    bool set(const char* pText) {
+        if (!pText || !strncmp(text, pText, N - 1))
+            return false;
+        strncpy(text, pText, N - 1);
+        text[N - 1] = '\0';
+        return true;
+    };
+
+    const char* c_str() const { return text; };
+    operator const char*() const { return text; };
+    bool empty() const { return !text[0]; };
+
+protected:
+    char text[N];
+};
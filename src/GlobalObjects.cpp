@@ -31,6 +31,8 @@
 TheBrain*  pTheBrain = nullptr;
 TempGauge* pTempGauge = nullptr;
 TimeStatus* pTimeStatus = nullptr;
+HistoryChart* pTempHistory = nullptr;
+HistoryChart* pWaterHistory = nullptr;
 
 lvppScreen* pScreenMain =  nullptr;
-lvppScreen* pScreenSetup = nullptr;
+LazyScreen* pScreenSetup = nullptr;
@@ -34,11 +34,15 @@
 class TheBrain;
 class TempGauge;
 class TimeStatus;
+class HistoryChart;
 class lvppScreen;
+class LazyScreen;
 
 extern TheBrain*       pTheBrain;
 extern TempGauge*      pTempGauge;
 extern TimeStatus*     pTimeStatus;
+extern HistoryChart*   pTempHistory;
+extern HistoryChart*   pWaterHistory;
 
 extern lvppScreen*     pScreenMain;
-extern lvppScreen*     pScreenSetup;
+extern LazyScreen*     pScreenSetup;
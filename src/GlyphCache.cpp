@@ -0,0 +1,180 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "GlyphCache.h"
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+struct CachedFont {
+    lv_font_t font;         // must stay first - LVGL hands us back &font
+    const lv_font_t* base;
+    uint8_t id;
+};
+
+struct GlyphEntry {
+    uint64_t key;
+    std::vector<uint8_t> mask;
+};
+
+static CachedFont fonts[GLYPH_CACHE_MAX_FONTS];
+static uint8_t fontCount = 0;
+
+static std::list<GlyphEntry> lru;      // front is most recently used
+static std::unordered_map<uint64_t, std::list<GlyphEntry>::iterator> lookup;
+static GlyphCacheStats stats = { 0, 0, 0, 0, 0 };
+static uint32_t budget = GLYPH_CACHE_BUDGET;
+
+// Same opacity tables LVGL uses when it draws 1/2/4 bpp glyphs, so the output is unchanged.
+static const uint8_t opa1[2]  = { 0, 255 };
+static const uint8_t opa2[4]  = { 0, 85, 170, 255 };
+static const uint8_t opa4[16] = { 0, 17, 34, 51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255 };
+
+static uint64_t makeKey(const CachedFont* cf, uint32_t letter) {
+    // LVGL 8 has no fractional glyph positions, so the subpixel mode of the font is the only offset.
+    return ((uint64_t)cf->id << 40) | ((uint64_t)cf->base->subpx << 32) | letter;
+}
+
+static void evictTo(uint32_t limit) {
+    while (stats.bytesInUse > limit && !lru.empty()) {
+        GlyphEntry& e = lru.back();
+        stats.bytesInUse -= e.mask.size();
+        stats.evictions++;
+        lookup.erase(e.key);
+        lru.pop_back();
+    }
+    stats.entries = lru.size();
+}
+
+static bool cachedGlyphDsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next) {
+    const CachedFont* cf = (const CachedFont*)font;
+    if (!cf->base->get_glyph_dsc(cf->base, dsc, letter, letter_next))
+        return false;
+
+    // Our bitmaps are always one byte per pixel.
+    dsc->bpp = 8;
+    return true;
+}
+
+static const uint8_t* cachedGlyphBitmap(const lv_font_t* font, uint32_t letter) {
+    const CachedFont* cf = (const CachedFont*)font;
+    const uint64_t key = makeKey(cf, letter);
+
+    auto found = lookup.find(key);
+    if (found != lookup.end()) {
+        stats.hits++;
+        lru.splice(lru.begin(), lru, found->second);
+        return lru.front().mask.data();
+    }
+
+    lv_font_glyph_dsc_t g;
+    if (!cf->base->get_glyph_dsc(cf->base, &g, letter, 0))
+        return nullptr;
+    const uint8_t* packed = cf->base->get_glyph_bitmap(cf->base, letter);
+    if (!packed)
+        return nullptr;
+
+    stats.misses++;
+    const uint32_t px = (uint32_t)g.box_w * g.box_h;
+
+    GlyphEntry e;
+    e.key = key;
+    e.mask.resize(px ? px : 1);
+
+    const uint8_t* table = g.bpp == 1 ? opa1 : g.bpp == 2 ? opa2 : opa4;
+    if (g.bpp == 8) {
+        memcpy(e.mask.data(), packed, px);
+    }
+    else {
+        // Glyph rows are packed back to back (no padding at row ends), most significant bits first.
+        // wrap() only takes 1/2/4 bpp here, so a value never straddles a byte.
+        const uint8_t mask = (1 << g.bpp) - 1;
+        uint32_t bit = 0;
+        for (uint32_t i = 0; i < px; i++, bit += g.bpp)
+            e.mask[i] = table[(packed[bit >> 3] >> (8 - g.bpp - (bit & 7))) & mask];
+    }
+
+    if (e.mask.size() > budget)
+        evictTo(0);
+    else
+        evictTo(budget - e.mask.size());
+
+    stats.bytesInUse += e.mask.size();
+    lru.push_front(std::move(e));
+    lookup[key] = lru.begin();
+    stats.entries = lru.size();
+    return lru.front().mask.data();
+}
+
+// Plain (uncompressed) lv_font_fmt_txt fonts of 1, 2, 4 or 8 bpp. LVGL decompresses compressed glyphs into
+// one shared buffer in a different layout, and other font engines may hand out anything.
+static bool cacheable(const lv_font_t* base) {
+    if (base->get_glyph_bitmap != lv_font_get_bitmap_fmt_txt || !base->dsc)
+        return false;
+    const lv_font_fmt_txt_dsc_t* dsc = (const lv_font_fmt_txt_dsc_t*)base->dsc;
+    return dsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN && (dsc->bpp == 1 || dsc->bpp == 2 || dsc->bpp == 4 || dsc->bpp == 8);
+}
+
+const lv_font_t* GlyphCache::wrap(const lv_font_t* base) {
+    if (!base)
+        return base;
+
+    for (uint8_t i = 0; i < fontCount; i++) {
+        if (fonts[i].base == base || &fonts[i].font == base)
+            return &fonts[i].font;
+    }
+    if (fontCount >= GLYPH_CACHE_MAX_FONTS || !cacheable(base))
+        return base;
+
+    CachedFont& cf = fonts[fontCount];
+    cf.font = *base;
+    cf.font.get_glyph_dsc = cachedGlyphDsc;
+    cf.font.get_glyph_bitmap = cachedGlyphBitmap;
+    cf.base = base;
+    cf.id = fontCount++;
+    return &cf.font;
+}
+
+void GlyphCache::setBudget(uint32_t bytes) {
+    budget = bytes;
+    evictTo(budget);
+}
+
+GlyphCacheStats GlyphCache::getStats() {
+    return stats;
+}
+
+void GlyphCache::resetStats() {
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+}
+
+void GlyphCache::clear() {
+    evictTo(0);
+}
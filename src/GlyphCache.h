@@ -0,0 +1,77 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <cstdint>
+
+#ifndef GLYPH_CACHE_BUDGET
+#ifdef ESP_PLATFORM
+#define GLYPH_CACHE_BUDGET (8U * 1024U)
+#else
+#define GLYPH_CACHE_BUDGET (64U * 1024U)
+#endif
+#endif
+
+// Most fonts that can be wrapped at once.
+#define GLYPH_CACHE_MAX_FONTS 8
+
+struct GlyphCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t bytesInUse;
+    uint32_t entries;
+
+    float hitRate() const { return hits + misses ? (float)hits / (hits + misses) : 0.0f; };
+};
+
+/**
+ * @brief Bounded cache of glyph bitmaps expanded to ready-to-blend 8-bit alpha masks.
+ * @details The Montserrat fonts store 4 bpp bitmaps. Every redraw of a label
+ *          decodes its glyphs again. wrap() returns a font which behaves exactly like the original but
+ *          reports 8 bpp glyphs, served from this cache. Value labels which redraw the same few digits
+ *          all day then mostly hit the cache. Costs RAM (GLYPH_CACHE_BUDGET), never flash.
+ *
+ *          Entries are keyed by font, code point and subpixel mode, with least-recently-used eviction.
+ *          Like the rest of LVGL, only use it from the thread holding the LVGL mutex.
+ */
+class GlyphCache {
+public:
+    /**
+     * @brief Cached stand-in for 'base'. Wrapping the same font twice returns the same wrapper.
+     * @return base itself if GLYPH_CACHE_MAX_FONTS are already wrapped, or if base isn't a plain (uncompressed)
+     *         1/2/4/8 bpp lv_font_fmt_txt font - such as LVGL's compressed built-in sizes.
+     */
+    static const lv_font_t* wrap(const lv_font_t* base);
+
+    static void setBudget(uint32_t bytes);
+    static GlyphCacheStats getStats();
+    static void resetStats();
+    static void clear();
+};
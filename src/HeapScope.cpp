@@ -0,0 +1,242 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "HeapScope.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if POOL_ALLOCATOR
+#include "PoolAllocator.h"
+#define lvRawAlloc   poolAlloc
+#define lvRawFree    poolFree
+#define lvRawRealloc poolRealloc
+#else
+#define lvRawAlloc   malloc
+#define lvRawFree    free
+#define lvRawRealloc realloc
+#endif
+
+#if HEAP_SCOPES
+
+struct ScopeSlot {
+    char name[HEAP_SCOPE_NAME_LEN + 1];
+    std::atomic<uint32_t> current;
+    std::atomic<uint32_t> peak;
+    std::atomic<uint32_t> allocs;
+};
+
+// Zero initialized before any constructor runs, so allocations made during static init are safe.
+static ScopeSlot slots[HEAP_SCOPE_MAX];
+static std::atomic<uint8_t> slotCount(1);
+static thread_local uint8_t threadScope = 0;
+
+// Keeps the user's block aligned the way malloc's was.
+struct AllocHeader {
+    uint32_t size;
+    uint8_t scope;
+};
+static const size_t headerSize = alignof(std::max_align_t);
+static_assert(sizeof(AllocHeader) <= alignof(std::max_align_t), "header must fit in the alignment padding");
+
+static uint8_t scopeId(const char* name) {
+    uint8_t n = slotCount.load(std::memory_order_acquire);
+    for (uint8_t i = 1; i < n; i++) {
+        if (!strncmp(slots[i].name, name, HEAP_SCOPE_NAME_LEN))
+            return i;
+    }
+
+    static std::mutex registering;
+    std::lock_guard<std::mutex> lock(registering);
+    n = slotCount.load(std::memory_order_relaxed);
+    for (uint8_t i = 1; i < n; i++) {
+        if (!strncmp(slots[i].name, name, HEAP_SCOPE_NAME_LEN))
+            return i;
+    }
+    if (n >= HEAP_SCOPE_MAX)
+        return 0;
+    strncpy(slots[n].name, name, HEAP_SCOPE_NAME_LEN);
+    slotCount.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+static inline void charge(uint8_t scope, uint32_t size) {
+    ScopeSlot& s = slots[scope];
+    uint32_t now = s.current.fetch_add(size, std::memory_order_relaxed) + size;
+    uint32_t peak = s.peak.load(std::memory_order_relaxed);
+    while (now > peak && !s.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+        ;
+    s.allocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+static inline void credit(uint8_t scope, uint32_t size) {
+    slots[scope].current.fetch_sub(size, std::memory_order_relaxed);
+}
+
+static inline void* tag(void* block, size_t size) {
+    if (!block)
+        return nullptr;
+    AllocHeader* h = (AllocHeader*)block;
+    h->size = (uint32_t)size;
+    h->scope = threadScope;
+    charge(h->scope, h->size);
+    return (uint8_t*)block + headerSize;
+}
+
+static inline AllocHeader* untag(void* ptr) {
+    AllocHeader* h = (AllocHeader*)((uint8_t*)ptr - headerSize);
+    credit(h->scope, h->size);
+    return h;
+}
+
+////////////////////////////////////////
+//
+//  LVGL heap (LV_MEM_CUSTOM_*)
+//
+////////////////////////////////////////
+
+void* heapScopeAlloc(size_t size) {
+    return tag(lvRawAlloc(size + headerSize), size);
+}
+
+void heapScopeFree(void* ptr) {
+    if (ptr)
+        lvRawFree(untag(ptr));
+}
+
+void* heapScopeRealloc(void* ptr, size_t size) {
+    if (!ptr)
+        return heapScopeAlloc(size);
+    if (!size) {
+        heapScopeFree(ptr);
+        return nullptr;
+    }
+
+    // The block stays charged to the scope which allocated it.
+    AllocHeader* h = (AllocHeader*)((uint8_t*)ptr - headerSize);
+    const uint8_t scope = h->scope;
+    const uint32_t oldSize = h->size;
+    h = (AllocHeader*)lvRawRealloc(h, size + headerSize);
+    if (!h)
+        return nullptr;
+
+    credit(scope, oldSize);
+    h->size = (uint32_t)size;
+    charge(scope, h->size);
+    return (uint8_t*)h + headerSize;
+}
+
+////////////////////////////////////////
+//
+//  C++ new/delete
+//
+////////////////////////////////////////
+
+static void* trackedNew(size_t size, bool nothrow) {
+    void* p = tag(malloc(size + headerSize), size);
+    if (!p && !nothrow) {
+#if __cpp_exceptions
+        throw std::bad_alloc();
+#else
+        abort();
+#endif
+    }
+    return p;
+}
+
+void* operator new(size_t size) { return trackedNew(size, false); }
+void* operator new[](size_t size) { return trackedNew(size, false); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedNew(size, true); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedNew(size, true); }
+
+void operator delete(void* ptr) noexcept { if (ptr) free(untag(ptr)); }
+void operator delete[](void* ptr) noexcept { if (ptr) free(untag(ptr)); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { if (ptr) free(untag(ptr)); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { if (ptr) free(untag(ptr)); }
+
+////////////////////////////////////////
+//
+//  Scopes
+//
+////////////////////////////////////////
+
+HeapScope::HeapScope(const char* name) {
+    previous = threadScope;
+    threadScope = scopeId(name);
+}
+
+HeapScope::~HeapScope() {
+    threadScope = previous;
+}
+
+void HeapScope::setThreadScope(const char* name) {
+    threadScope = scopeId(name);
+}
+
+uint8_t HeapScope::count() {
+    return slotCount.load(std::memory_order_acquire);
+}
+
+bool HeapScope::getStats(uint8_t id, HeapScopeStats& stats) {
+    if (id >= count())
+        return false;
+    stats.name = id ? slots[id].name : "other";
+    stats.current = slots[id].current.load(std::memory_order_relaxed);
+    stats.peak = slots[id].peak.load(std::memory_order_relaxed);
+    stats.allocs = slots[id].allocs.load(std::memory_order_relaxed);
+    return true;
+}
+
+void HeapScope::report() {
+    HeapScopeStats s;
+    uint32_t total = 0;
+    printf("Heap by scope              current       peak     allocs\n");
+    for (uint8_t i = 0; getStats(i, s); i++) {
+        printf("  %-23s %10u %10u %10u\n", s.name, s.current, s.peak, s.allocs);
+        total += s.current;
+    }
+    printf("  %-23s %10u\n", "total", total);
+}
+
+#else   // HEAP_SCOPES
+
+void* heapScopeAlloc(size_t size) { return lvRawAlloc(size); }
+void heapScopeFree(void* ptr) { lvRawFree(ptr); }
+void* heapScopeRealloc(void* ptr, size_t size) { return lvRawRealloc(ptr, size); }
+
+HeapScope::HeapScope(const char*) : previous(0) {}
+HeapScope::~HeapScope() {}
+void HeapScope::setThreadScope(const char*) {}
+uint8_t HeapScope::count() { return 0; }
+bool HeapScope::getStats(uint8_t, HeapScopeStats&) { return false; }
+void HeapScope::report() { printf("Heap attribution is off - build with -D HEAP_SCOPES=1\n"); }
+
+#endif  // HEAP_SCOPES
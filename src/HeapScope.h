@@ -0,0 +1,106 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+//
+// Heap attribution. Every allocation is charged to the scope active on the calling thread when it
+// was made - a screen, a widget, the renderer, a RoboTask - and credited back to that same scope
+// when freed. Costs one header (8 bytes on the ESP32, 16 natively) and three atomic updates per
+// allocation, which is cheap enough to leave on in field builds. Turned on with HEAP_SCOPES=1.
+//
+// C++ new/delete are tracked by replacing the global operators. LVGL's heap is tracked by pointing
+// LV_MEM_CUSTOM_* at heapScopeAlloc/Free/Realloc (lv_conf.h, or the emulator flags in platformio.ini),
+// which also forward to the pool allocator when POOL_ALLOCATOR=1. Plain malloc() is not tracked.
+//
+// This header is included by LVGL's C sources, so everything outside __cplusplus has to stay plain C.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HEAP_SCOPES
+#define HEAP_SCOPES 0
+#endif
+
+#define HEAP_SCOPE_MAX      32      // scope 0 is "other" - allocations made outside any scope
+#define HEAP_SCOPE_NAME_LEN 23
+
+// How often the main loops print HeapScope::report(). 0 = never.
+#ifndef HEAP_SCOPE_REPORT_MS
+#define HEAP_SCOPE_REPORT_MS 60000
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* heapScopeAlloc(size_t size);
+void heapScopeFree(void* ptr);
+void* heapScopeRealloc(void* ptr, size_t size);
+
+#ifdef __cplusplus
+}
+
+struct HeapScopeStats {
+    const char* name;
+    uint32_t current;   // bytes
+    uint32_t peak;
+    uint32_t allocs;    // allocations ever made in this scope
+};
+
+/**
+ * @brief RAII scope - allocations on this thread are charged to 'name' until it goes out of scope.
+ *        Scopes nest; the innermost one wins. Names are registered on first use (up to HEAP_SCOPE_MAX,
+ *        after that they count as "other") and copied, so temporaries are fine.
+ * @code
+ *     HeapScope scope("main screen");
+ *     pScreenMain = new lvppScreen(lv_scr_act());
+ * @endcode
+ */
+class HeapScope {
+public:
+    explicit HeapScope(const char* name);
+    ~HeapScope();
+
+    /**
+     * @brief Sets the scope for the rest of this thread's life. RoboTask threads start in their task name.
+     */
+    static void setThreadScope(const char* name);
+
+    static uint8_t count();
+    static bool getStats(uint8_t id, HeapScopeStats& stats);
+
+    /**
+     * @brief Prints current and peak bytes of every scope.
+     */
+    static void report();
+
+protected:
+    uint8_t previous;
+};
+#endif
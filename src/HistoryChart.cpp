@@ -0,0 +1,181 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "HistoryChart.h"
+#include <cassert>
+
+HistoryChartStats HistoryChart::totals;
+
+HistoryChart::HistoryChart(const char* fName, lv_coord_t _width, lv_coord_t height, int16_t _low, int16_t _high, uint16_t _samplesPerColumn)
+    : lvppBase(fName, "HISTORYCHART") {
+    assert(_width > 1 && _high > _low && _samplesPerColumn > 0);
+    width = _width;
+    low = _low;
+    high = _high;
+    samplesPerColumn = _samplesPerColumn;
+    cursor = 0;
+    samplesInColumn = 0;
+    filled = 0;
+    lastValue = low;
+    traceColor = lv_color_black();
+
+    columns = new Column[width];
+    assert(columns);
+
+    // A bare rectangle - the columns are drawn straight from the ring, so no border or padding to allow for.
+    createObj(lv_obj_create(lv_scr_act()));
+    setSize(width, height);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_border_width(obj, 0, 0);
+    lv_obj_set_style_radius(obj, 0, 0);
+    lv_obj_set_style_pad_all(obj, 0, 0);
+    lv_obj_set_style_bg_color(obj, lv_color_white(), 0);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, 0);
+    lv_obj_add_event_cb(obj, drawEvent, LV_EVENT_DRAW_MAIN, this);
+}
+
+HistoryChart::~HistoryChart() {
+    delete[] columns;
+}
+
+void HistoryChart::append(int16_t value) {
+    totals.appends++;
+    value = value < low ? low : (value > high ? high : value);
+
+    if (filled && samplesInColumn < samplesPerColumn) {
+        // Same column - only redrawn if its envelope grew.
+        Column& column = columns[cursor];
+        bool grew = false;
+        if (value < column.min) {
+            column.min = value;
+            grew = true;
+        }
+        if (value > column.max) {
+            column.max = value;
+            grew = true;
+        }
+        samplesInColumn++;
+        lastValue = value;
+        if (grew)
+            invalidateColumns(cursor, 1);
+        return;
+    }
+
+    // A new column over the oldest one. It starts from the previous sample so the columns join up into one trace.
+    if (filled)
+        cursor = (cursor + 1) % width;
+    Column& column = columns[cursor];
+    column.min = column.max = value;
+    if (filled) {
+        if (lastValue < column.min)
+            column.min = lastValue;
+        if (lastValue > column.max)
+            column.max = lastValue;
+    }
+    if (filled < width - 1)
+        filled++;
+    samplesInColumn = 1;
+    lastValue = value;
+
+    // The new column, and the gap moving one ahead of it over what was the oldest column.
+    invalidateColumns(cursor, 2);
+}
+
+void HistoryChart::clear() {
+    cursor = 0;
+    samplesInColumn = 0;
+    filled = 0;
+    lv_obj_invalidate(obj);
+}
+
+void HistoryChart::setColors(lv_color_t trace, lv_color_t background) {
+    traceColor = trace;
+    lv_obj_set_style_bg_color(obj, background, 0);
+    lv_obj_invalidate(obj);
+}
+
+void HistoryChart::invalidateColumns(uint16_t first, uint16_t count) {
+    // Wrapping past the right edge continues at the left.
+    if (first + count > width) {
+        invalidateColumns(0, first + count - width);
+        count = width - first;
+    }
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t area;
+    lv_area_set(&area, coords.x1 + first, coords.y1, coords.x1 + first + count - 1, coords.y2);
+    lv_obj_invalidate_area(obj, &area);
+    totals.invalidations++;
+}
+
+lv_coord_t HistoryChart::valueToY(int16_t value, const lv_area_t& coords) const {
+    int32_t rows = lv_area_get_height(&coords) - 1;
+    return coords.y2 - (lv_coord_t) ((int32_t) (value - low) * rows / (high - low));
+}
+
+void HistoryChart::drawEvent(lv_event_t* e) {
+    HistoryChart* self = (HistoryChart*) lv_event_get_user_data(e);
+    self->draw(lv_event_get_draw_ctx(e));
+}
+
+void HistoryChart::draw(lv_draw_ctx_t* drawCtx) {
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t clip;
+    if (!_lv_area_intersect(&clip, &coords, drawCtx->clip_area))
+        return;
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = traceColor;
+
+    // Only the columns LVGL is redrawing - usually the one or two append() invalidated.
+    for (lv_coord_t x = clip.x1; x <= clip.x2; x++) {
+        uint16_t index = x - coords.x1;
+        // Age 0 is the cursor column. The gap ahead of it is the oldest (width - 1), never filled.
+        uint16_t age = (cursor + width - index) % width;
+        if (age >= filled)
+            continue;
+
+        lv_area_t bar;
+        lv_area_set(&bar, x, valueToY(columns[index].max, coords), x, valueToY(columns[index].min, coords));
+        lv_draw_rect(drawCtx, &dsc, &bar);
+        totals.columnsDrawn++;
+    }
+}
+
+HistoryChartStats HistoryChart::getStats() {
+    return totals;
+}
+
+void HistoryChart::resetStats() {
+    totals.appends = 0;
+    totals.invalidations = 0;
+    totals.columnsDrawn = 0;
+}
@@ -0,0 +1,104 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <cstdint>
+
+/**
+ * @brief Totals across every HistoryChart, for the benchmarks.
+ */
+struct HistoryChartStats {
+    uint32_t appends;           // Samples handed to append()
+    uint32_t invalidations;     // lv_obj_invalidate_area() calls made by append()
+    uint32_t columnsDrawn;      // Column bars drawn (the clip area decides how many per redraw)
+};
+
+/**
+ * @brief A strip chart of recent history, one pixel column per samplesPerColumn samples.
+ * @details The history is a ring of width columns, each holding only the min/max envelope of its samples,
+ *          so memory and draw cost depend on the pixel width - never on how many samples went in.
+ *          New columns are written left to right over the oldest ones (a sweep, like a monitor trace)
+ *          with a blank column ahead of the cursor marking "now". Nothing on screen moves, so an append
+ *          invalidates at most the cursor column and the gap ahead of it, and nothing at all while the
+ *          envelope doesn't grow. A redraw only draws the columns inside LVGL's clip area.
+ *
+ *          An lvpp widget on a plain lv_obj, placed with align() and lvppScreen::addObject() like the rest;
+ *          setValue() (and so lvppScreen::setObjValue()) appends. The size is fixed at construction.
+ *          Call from the LVGL thread (or with the LVGL mutex held).
+ */
+class HistoryChart : public lvppBase {
+public:
+    /**
+     * @param low, high          Value range mapped to the bottom and top rows. Samples outside are clamped.
+     * @param samplesPerColumn   Samples folded into each column's min/max envelope.
+     */
+    HistoryChart(const char* fName, lv_coord_t width, lv_coord_t height, int16_t low, int16_t high, uint16_t samplesPerColumn = 1);
+    virtual ~HistoryChart();
+
+    void append(int16_t value);
+    void setValue(int16_t value) { append(value); };
+    /**
+     * @brief Forgets all history (and redraws the chart empty).
+     */
+    void clear();
+
+    void setColors(lv_color_t trace, lv_color_t background);
+    /**
+     * @brief Columns holding history so far - up to the width less the gap column.
+     */
+    uint16_t getColumns() const { return filled; };
+
+    static HistoryChartStats getStats();
+    static void resetStats();
+
+protected:
+    struct Column {
+        int16_t min;
+        int16_t max;
+    };
+
+    static void drawEvent(lv_event_t* e);
+    void draw(lv_draw_ctx_t* drawCtx);
+    void invalidateColumns(uint16_t first, uint16_t count);
+    lv_coord_t valueToY(int16_t value, const lv_area_t& coords) const;
+
+    Column* columns;
+    uint16_t width;
+    int16_t low;
+    int16_t high;
+    uint16_t samplesPerColumn;
+    // Column being written and how many samples it has so far.
+    uint16_t cursor;
+    uint16_t samplesInColumn;
+    uint16_t filled;
+    int16_t lastValue;
+    lv_color_t traceColor;
+
+    static HistoryChartStats totals;
+};
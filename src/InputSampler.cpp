@@ -0,0 +1,225 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "InputSampler.h"
+#include "BootProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+InputSampler* InputSampler::instance = nullptr;
+InputLatencyStats InputSampler::stats;
+
+InputSampler* InputSampler::attach(lv_indev_t* indev, uint32_t periodMS) {
+    if (instance)
+        return instance;
+
+    if (!indev) {
+        for (indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev))
+            if (indev->driver->type == LV_INDEV_TYPE_POINTER)
+                break;
+    }
+    if (!indev || !indev->driver->read_cb) {
+        printf("InputSampler: no pointer input device to sample.\n");
+        return nullptr;
+    }
+
+    instance = new InputSampler(indev, periodMS);
+    return instance;
+}
+
+InputSampler::InputSampler(lv_indev_t* _indev, uint32_t periodMS) : RoboTask("InputSampler", 2) {
+    indev = _indev;
+    memset(&lastQueued, 0, sizeof(lastQueued));
+    memset(&current, 0, sizeof(current));
+    memset(&target, 0, sizeof(target));
+    pending = targetFlushed = false;
+    pendingUS = pendingTick = 0;
+    historyCount = 0;
+    resetStats();
+
+    // From now on the device is only read by the sampler, and LVGL reads the queue.
+    deviceRead = indev->driver->read_cb;
+    indev->driver->read_cb = drain;
+    prevFeedback = indev->driver->feedback_cb;
+    indev->driver->feedback_cb = feedback;
+
+    lv_disp_t* disp = indev->driver->disp ? indev->driver->disp : lv_disp_get_default();
+    prevFlush = disp->driver->flush_cb;
+    disp->driver->flush_cb = flushed;
+    prevMonitor = disp->driver->monitor_cb;
+    disp->driver->monitor_cb = refreshed;
+
+    setBaseRunDelay(periodMS);
+}
+
+void InputSampler::Run() {
+    sampleNow();
+}
+
+bool InputSampler::sampleNow() {
+    lv_indev_data_t data;
+    memset(&data, 0, sizeof(data));
+    data.point.x = lastQueued.x;
+    data.point.y = lastQueued.y;
+    deviceRead(indev->driver, &data);
+
+    InputSample sample;
+    sample.us = BootProfiler::nowUS();
+    sample.pressed = data.state == LV_INDEV_STATE_PR;
+    // Drivers only fill in the point while pressed - a release happens where the last press was.
+    sample.x = sample.pressed ? data.point.x : lastQueued.x;
+    sample.y = sample.pressed ? data.point.y : lastQueued.y;
+
+    if (sample.pressed == lastQueued.pressed && (!sample.pressed || (sample.x == lastQueued.x && sample.y == lastQueued.y)))
+        return false;
+
+    // lastQueued only moves on success, so a press or release which didn't fit is retried next time.
+    if (!queue.push(sample)) {
+        stats.overflows++;
+        return false;
+    }
+    lastQueued = sample;
+    stats.samples++;
+    return true;
+}
+
+void InputSampler::drain(lv_indev_drv_t* drv, lv_indev_data_t* data) {
+    InputSampler* s = instance;
+
+    // A whole indev period after the event its widget wasn't redrawn, and nothing is left to draw.
+    if (s->pending && lv_tick_elaps(s->pendingTick) >= drv->read_timer->period) {
+        lv_disp_t* disp = drv->disp ? drv->disp : lv_disp_get_default();
+        if (!disp->inv_p) {
+            stats.unreflected++;
+            s->pending = false;
+        }
+    }
+
+#if INPUT_SAMPLE_IN_READ
+    // Only safe to read here, on LVGL's thread - see INPUT_SAMPLE_IN_READ.
+    s->sampleNow();
+#endif
+
+    InputSample sample;
+    if (s->queue.pop(sample)) {
+        s->current = sample;
+        stats.delivered++;
+        // Hand over the rest in this same read, so LVGL sees every press and release in order.
+        data->continue_reading = !s->queue.empty();
+    }
+
+    data->point.x = s->current.x;
+    data->point.y = s->current.y;
+    data->state = s->current.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+}
+
+void InputSampler::feedback(lv_indev_drv_t* drv, uint8_t code) {
+    InputSampler* s = instance;
+    if (code == LV_EVENT_PRESSED || code == LV_EVENT_RELEASED) {
+        // LVGL handles each read before the next one, so s->current is the sample behind this event.
+        lv_obj_t* obj = lv_indev_get_obj_act();
+        if (!obj || !lv_obj_get_parent(obj)) {
+            stats.unreflected++;
+        } else {
+            lv_area_t area;
+            lv_obj_get_coords(obj, &area);
+            if (!s->pending) {
+                s->pending = true;
+                s->targetFlushed = false;
+                s->target = area;
+                s->pendingUS = s->current.us;
+            } else {
+                _lv_area_join(&s->target, &s->target, &area);
+            }
+            s->pendingTick = lv_tick_get();
+        }
+    }
+
+    if (s->prevFeedback)
+        s->prevFeedback(drv, code);
+}
+
+void InputSampler::flushed(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* pixels) {
+    InputSampler* s = instance;
+    lv_area_t common;
+    if (s->pending && _lv_area_intersect(&common, area, &s->target))
+        s->targetFlushed = true;
+
+    s->prevFlush(drv, area, pixels);
+}
+
+void InputSampler::refreshed(lv_disp_drv_t* drv, uint32_t time, uint32_t px) {
+    InputSampler* s = instance;
+    if (s->pending && s->targetFlushed) {
+        s->pending = s->targetFlushed = false;
+        s->recordLatency(BootProfiler::nowUS() - s->pendingUS);
+    }
+
+    if (s->prevMonitor)
+        s->prevMonitor(drv, time, px);
+}
+
+void InputSampler::recordLatency(uint32_t us) {
+    stats.measured++;
+    stats.lastUS = us;
+    stats.totalUS += us;
+    if (us > stats.maxUS)
+        stats.maxUS = us;
+    history[historyCount++ % INPUT_LATENCY_HISTORY] = us;
+}
+
+uint32_t InputSampler::latencyPercentileUS(double pct) {
+    if (!instance || !instance->historyCount)
+        return 0;
+    uint32_t n = std::min<uint32_t>(instance->historyCount, INPUT_LATENCY_HISTORY);
+    std::vector<uint32_t> sorted(instance->history, instance->history + n);
+    std::sort(sorted.begin(), sorted.end());
+    size_t index = (size_t)(pct / 100.0 * (n - 1) + 0.5);
+    return sorted[std::min<size_t>(index, n - 1)];
+}
+
+void InputSampler::resetStats() {
+    stats.samples = 0;
+    stats.overflows = 0;
+    stats.delivered = 0;
+    stats.measured = 0;
+    stats.unreflected = 0;
+    stats.lastUS = stats.maxUS = 0;
+    stats.totalUS = 0;
+    if (instance)
+        instance->historyCount = 0;
+}
+
+void InputSampler::report() {
+    printf("Touch-to-photon: %u presses/releases measured, p50 %.1f ms, p99 %.1f ms, max %.1f ms, mean %.1f ms\n",
+           stats.measured.load(), latencyPercentileUS(50) / 1000.0, latencyPercentileUS(99) / 1000.0,
+           stats.maxUS / 1000.0, stats.meanMS());
+    printf("  %u samples, %u delivered, %u presses/releases without a redraw, %u dropped (queue full)\n",
+           stats.samples.load(), stats.delivered.load(), stats.unreflected.load(), stats.overflows.load());
+}
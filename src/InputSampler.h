@@ -0,0 +1,172 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include "robotask.h"
+#include "SpscQueue.h"
+#include <atomic>
+
+// How often the sampler task reads the pointer - LVGL itself only reads every LV_INDEV_DEF_READ_PERIOD.
+#ifndef INPUT_SAMPLE_PERIOD_MS
+#define INPUT_SAMPLE_PERIOD_MS 5
+#endif
+
+// Read the device inside LVGL's indev read, on LVGL's thread, instead of on the sampler task. The native
+// builds need this: lv_drivers' SDL mouse state is written by its event handler on the LVGL thread, so
+// reading it from another thread would race. Samples are still timestamped and queued the same way.
+#ifndef INPUT_SAMPLE_IN_READ
+#ifdef ESP_PLATFORM
+#define INPUT_SAMPLE_IN_READ 0
+#else
+#define INPUT_SAMPLE_IN_READ 1
+#endif
+#endif
+
+// Samples waiting for LVGL. Power of two. Only changes are queued, so this covers seconds of dragging.
+#ifndef INPUT_QUEUE_SIZE
+#define INPUT_QUEUE_SIZE 64
+#endif
+
+// Latencies kept for the percentiles.
+#ifndef INPUT_LATENCY_HISTORY
+#define INPUT_LATENCY_HISTORY 128
+#endif
+
+// Print the touch-to-photon report this often from the emulator/ESP32 loop (0 = never).
+#ifndef INPUT_LATENCY_REPORT_MS
+#define INPUT_LATENCY_REPORT_MS 60000
+#endif
+
+struct InputSample {
+    uint32_t us;            // BootProfiler::nowUS() when the device was read
+    lv_coord_t x;
+    lv_coord_t y;
+    bool pressed;
+};
+
+// samples and overflows are written by the sampler task, the rest by LVGL. The counters are atomic so they
+// can be read anywhere; the latencies (and latencyPercentileUS()/report()) need the LVGL mutex.
+struct InputLatencyStats {
+    std::atomic<uint32_t> samples;      // queued by the sampler (press, release, or a move while pressed)
+    std::atomic<uint32_t> overflows;    // not queued - LVGL fell INPUT_QUEUE_SIZE samples behind
+    std::atomic<uint32_t> delivered;    // handed to LVGL by the indev read
+    std::atomic<uint32_t> measured;     // presses/releases whose widget was seen redrawn
+    std::atomic<uint32_t> unreflected;  // presses/releases that redrew nothing (e.g. a tap on the background)
+    // LVGL side only - read with the LVGL mutex held
+    uint32_t lastUS;
+    uint32_t maxUS;
+    uint64_t totalUS;
+
+    double meanMS() const {
+        uint32_t n = measured;
+        return n ? totalUS / 1000.0 / n : 0.0;
+    };
+};
+
+/**
+ * @brief Reads the pointer on its own task, at its own rate, into a lock-free queue of timestamped samples.
+ * @details attach() takes over a registered pointer indev. Its read_cb becomes the sampler's source and is
+ *          called only from the sampler task (or sampleNow()). LVGL's read then drains the queue, one sample
+ *          per read, using continue_reading so a tap shorter than the indev period still arrives as a press
+ *          and a release. The device is never read inside lv_task_handler() with the LVGL mutex held.
+ *          Where the device can't be read from another thread (INPUT_SAMPLE_IN_READ, the native builds'
+ *          SDL mouse), LVGL's read samples it first, on LVGL's thread, and the task isn't started. Taps
+ *          shorter than the indev period can be missed there, as with the plain SDL driver.
+ *
+ *          Touch-to-photon latency is tied to the input's own effect. When LVGL sends LV_EVENT_PRESSED or
+ *          LV_EVENT_RELEASED (the indev feedback_cb), the area of the widget it went to becomes the target,
+ *          timed from the sample that caused it. Each flush is checked against that area, and the latency
+ *          ends with the refresh (monitor_cb) that flushed part of it. Events before then add their widget
+ *          to the target and keep the earliest time. Unrelated redraws, like a clock ticking over, don't
+ *          end it. A press on the screen itself, or a target still not redrawn an indev period later with
+ *          nothing left invalidated, is counted as unreflected. Moves while pressed aren't timed.
+ *
+ *          attach() chains the display's flush_cb and monitor_cb and the indev's feedback_cb.
+ *          There is one sampler per program. Call attach() before BootProfiler::watchFirstFrame(), which
+ *          restores the monitor_cb it found, then Start() once the touch hardware is up (unless
+ *          INPUT_SAMPLE_IN_READ). Scripted input
+ *          (the benchmarks) can leave the task paused and call sampleNow() after setting the pointer.
+ */
+class InputSampler : public RoboTask {
+public:
+    /**
+     * @param indev A pointer indev, or nullptr for the first one registered.
+     * @return The sampler, paused, or nullptr when there is no pointer indev.
+     */
+    static InputSampler* attach(lv_indev_t* indev = nullptr, uint32_t periodMS = INPUT_SAMPLE_PERIOD_MS);
+    static InputSampler* get() { return instance; };
+
+    /**
+     * @brief Reads the device once and queues the result if it changed. Returns true if a sample was queued.
+     * @note Producer side - call it from one thread only (the task's own Run() when the task is running).
+     */
+    bool sampleNow();
+
+    void Run();
+
+    /**
+     * @note The latency fields, latencyPercentileUS(), resetStats() and report() belong to LVGL's side: call
+     *       them from the LVGL thread or with LockingRoboTask::TakeMutex() held.
+     */
+    static const InputLatencyStats& getStats() { return stats; };
+    static uint32_t latencyPercentileUS(double pct);
+    static void resetStats();
+    static void report();
+
+protected:
+    InputSampler(lv_indev_t* indev, uint32_t periodMS);
+
+    static void drain(lv_indev_drv_t* drv, lv_indev_data_t* data);
+    static void feedback(lv_indev_drv_t* drv, uint8_t code);
+    static void flushed(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* pixels);
+    static void refreshed(lv_disp_drv_t* drv, uint32_t time, uint32_t px);
+    void recordLatency(uint32_t us);
+
+    static InputSampler* instance;
+    static InputLatencyStats stats;
+
+    lv_indev_t* indev;
+    void (*deviceRead)(lv_indev_drv_t* drv, lv_indev_data_t* data);
+    void (*prevFeedback)(lv_indev_drv_t* drv, uint8_t code);
+    void (*prevFlush)(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* pixels);
+    void (*prevMonitor)(lv_disp_drv_t* drv, uint32_t time, uint32_t px);
+    SpscQueue<InputSample, INPUT_QUEUE_SIZE> queue;
+
+    // Sampler side
+    InputSample lastQueued;
+    // LVGL side
+    InputSample current;
+    bool pending;               // a press/release target is waiting to be redrawn
+    bool targetFlushed;         // ...and part of it went out in the refresh under way
+    lv_area_t target;
+    uint32_t pendingUS;
+    uint32_t pendingTick;
+    uint32_t history[INPUT_LATENCY_HISTORY];
+    uint32_t historyCount;
+};
@@ -0,0 +1,186 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "LazyScreen.h"
+#include "HeapScope.h"
+#include "ScreenTransition.h"
+
+LazyScreen::LazyScreen(const char* _name, Builder _builder, uint32_t _releaseAfterMS)
+    : name(_name), builder(_builder), releaseAfterMS(_releaseAfterMS), screen(nullptr), timer(nullptr), buildCount(0) {
+}
+
+LazyScreen::~LazyScreen() {
+    stopReleaseTimer();
+    if (screen && lv_scr_act() != screen->getScreen())
+        release();
+}
+
+void LazyScreen::activateScreen(uint32_t animTimeMS, lv_scr_load_anim_t anim) {
+    ScreenTransition::activate(getScreen(), animTimeMS, anim);
+}
+
+lvppScreen* LazyScreen::getScreen() {
+    if (!screen)
+        build();
+    return screen;
+}
+
+void LazyScreen::addObject(lvppBase* widget) {
+    screen->addObject(widget);
+}
+
+void LazyScreen::setStateHooks(std::function<void()> save, std::function<void()> restore) {
+    onSave = save;
+    onRestore = restore;
+}
+
+void LazyScreen::build() {
+    HeapScope scope(name.c_str());
+
+    screen = new lvppScreen();
+    builder(*this);
+    buildCount++;
+
+    // Unloaded - start the countdown to teardown. Loaded again in time - cancel it.
+    lv_obj_t* scr = screen->getScreen();
+    lv_obj_add_event_cb(scr, screenEvent, LV_EVENT_SCREEN_UNLOADED, this);
+    lv_obj_add_event_cb(scr, screenEvent, LV_EVENT_SCREEN_LOAD_START, this);
+
+    if (buildCount > 1)
+        restoreState();
+}
+
+void LazyScreen::release() {
+    if (!screen)
+        return;
+    lv_obj_t* scr = screen->getScreen();
+    if (lv_scr_act() == scr)
+        return;
+
+    stopReleaseTimer();
+    saveState();
+
+    // Unhook each widget's callbacks first so no event reaches a widget that is already gone, then
+    // delete the widgets newest first and finally whatever is left of the screen.
+    lv_obj_remove_event_cb_with_user_data(scr, screenEvent, this);
+    for (auto it = owned.rbegin(); it != owned.rend(); ++it) {
+        lv_obj_t* obj = (*it)->getObj();
+        if (obj && lv_obj_is_valid(obj))
+            lv_obj_remove_event_cb_with_user_data(obj, NULL, *it);
+        delete *it;
+    }
+    owned.clear();
+
+    delete screen;
+    screen = nullptr;
+    if (lv_obj_is_valid(scr))
+        lv_obj_del(scr);
+}
+
+void LazyScreen::saveState() {
+    saved.clear();
+    for (lvppBase* w : owned) {
+        lv_obj_t* obj = w->getObj();
+        if (!obj)
+            continue;
+
+        SavedState s;
+        s.name = w->getName();
+        s.hasValue = true;
+        if (lv_obj_check_type(obj, &lv_bar_class) || lv_obj_check_type(obj, &lv_slider_class))
+            s.value = lv_bar_get_value(obj);
+        else if (lv_obj_check_type(obj, &lv_arc_class))
+            s.value = lv_arc_get_value(obj);
+        else if (lv_obj_check_type(obj, &lv_dropdown_class))
+            s.value = lv_dropdown_get_selected(obj);
+        else
+            s.hasValue = false;
+        s.checked = lv_obj_has_state(obj, LV_STATE_CHECKED);
+        saved.push_back(s);
+    }
+
+    if (onSave)
+        onSave();
+}
+
+void LazyScreen::restoreState() {
+    for (const SavedState& s : saved) {
+        lvppBase* w = screen->findObj(s.name.c_str());
+        if (!w || !w->getObj())
+            continue;
+
+        lv_obj_t* obj = w->getObj();
+        if (s.hasValue) {
+            if (lv_obj_check_type(obj, &lv_dropdown_class))
+                lv_dropdown_set_selected(obj, (uint16_t)s.value);
+            else
+                w->setValue((int16_t)s.value);     // keeps the lvpp side (value label etc.) in step
+        }
+        if (s.checked)
+            lv_obj_add_state(obj, LV_STATE_CHECKED);
+        else
+            lv_obj_clear_state(obj, LV_STATE_CHECKED);
+    }
+    saved.clear();
+
+    if (onRestore)
+        onRestore();
+}
+
+void LazyScreen::startReleaseTimer() {
+    if (!releaseAfterMS)
+        return;
+    if (!timer) {
+        timer = lv_timer_create(releaseTimer, releaseAfterMS, this);
+        lv_timer_set_repeat_count(timer, 1);
+    }
+    else {
+        lv_timer_reset(timer);
+    }
+}
+
+void LazyScreen::stopReleaseTimer() {
+    if (timer) {
+        lv_timer_del(timer);
+        timer = nullptr;
+    }
+}
+
+void LazyScreen::screenEvent(lv_event_t* e) {
+    LazyScreen* self = (LazyScreen*)lv_event_get_user_data(e);
+    if (lv_event_get_code(e) == LV_EVENT_SCREEN_UNLOADED)
+        self->startReleaseTimer();
+    else
+        self->stopReleaseTimer();
+}
+
+void LazyScreen::releaseTimer(lv_timer_t* t) {
+    LazyScreen* self = (LazyScreen*)t->user_data;
+    // A one-shot timer deletes itself after this call.
+    self->timer = nullptr;
+    self->release();
+}
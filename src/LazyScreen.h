@@ -0,0 +1,145 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include "WidgetHandle.h"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Inactive lazy screens are torn down this long after they were last shown. 0 keeps them forever.
+#ifndef LAZY_SCREEN_RELEASE_MS
+#ifdef ESP_PLATFORM
+#define LAZY_SCREEN_RELEASE_MS 30000
+#else
+#define LAZY_SCREEN_RELEASE_MS 0
+#endif
+#endif
+
+/**
+ * @brief A screen which is described up front but only constructed the first time it is shown.
+ * @details The builder creates the widgets with create<T>() (heap allocated, owned by this screen) and
+ *          adds them with addObject(). Nothing is built until the first activateScreen() or getScreen().
+ *
+ *          With a release time set, the screen is torn down that long after it was unloaded and rebuilt
+ *          when shown again. Before teardown the values of the owned bars, sliders, arcs and dropdowns and
+ *          the checked state of every owned widget are saved by widget name, and put back after the
+ *          rebuild. Anything else (text, state held outside the widgets) can be carried across with
+ *          setStateHooks().
+ * @code
+ *     pScreenSetup = new LazyScreen("setup screen", [](LazyScreen& screen) {
+ *         lvppButton* exit = screen.create<lvppButton>("ExitSetup", "Exit");
+ *         screen.addObject(exit);
+ *     });
+ *     pScreenSetup->activateScreen(500, LV_SCR_LOAD_ANIM_OVER_LEFT);
+ * @endcode
+ */
+class LazyScreen {
+public:
+    typedef std::function<void(LazyScreen& screen)> Builder;
+
+    LazyScreen(const char* name, Builder builder, uint32_t releaseAfterMS = LAZY_SCREEN_RELEASE_MS);
+    ~LazyScreen();
+
+    /**
+     * @brief Builds the screen if needed, then loads it through ScreenTransition (snapshots when the
+     *        budget allows, lvppScreen::activateScreen() otherwise).
+     */
+    void activateScreen(uint32_t animTimeMS = 0, lv_scr_load_anim_t anim = LV_SCR_LOAD_ANIM_NONE);
+
+    /**
+     * @brief The underlying lvppScreen, built on demand.
+     */
+    lvppScreen* getScreen();
+
+    bool isBuilt() const { return screen != nullptr; };
+    uint32_t getBuildCount() const { return buildCount; };
+
+    /**
+     * @brief Tears the screen down now (saving its state). Ignored while it is the active screen.
+     */
+    void release();
+
+    /**
+     * @brief Release the screen this long after it was unloaded. 0 = never.
+     */
+    void setReleaseAfter(uint32_t ms) { releaseAfterMS = ms; };
+
+    /**
+     * @brief Called right before teardown and right after the rebuild, for state the widgets don't hold.
+     */
+    void setStateHooks(std::function<void()> save, std::function<void()> restore);
+
+    /**
+     * @brief For use in the builder - creates a widget owned (and later deleted) by this screen, and
+     *        registers it for WidgetHandles.
+     */
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        T* widget = new T(std::forward<Args>(args)...);
+        WidgetHandle<T>::of(widget);
+        adopt(widget);
+        return widget;
+    };
+
+    /**
+     * @brief For use in the builder - hands a heap allocated widget to this screen, which deletes it on release.
+     */
+    void adopt(lvppBase* widget) { owned.push_back(widget); };
+
+    void addObject(lvppBase* widget);
+
+protected:
+    struct SavedState {
+        std::string name;
+        int32_t value;
+        bool hasValue;
+        bool checked;
+    };
+
+    void build();
+    void saveState();
+    void restoreState();
+    void startReleaseTimer();
+    void stopReleaseTimer();
+    static void screenEvent(lv_event_t* e);
+    static void releaseTimer(lv_timer_t* timer);
+
+    std::string name;
+    Builder builder;
+    uint32_t releaseAfterMS;
+    lvppScreen* screen;
+    std::vector<lvppBase*> owned;
+    std::vector<SavedState> saved;
+    std::function<void()> onSave;
+    std::function<void()> onRestore;
+    lv_timer_t* timer;
+    uint32_t buildCount;
+};
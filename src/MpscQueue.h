@@ -0,0 +1,115 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "SpscQueue.h"
+
+/**
+ * @brief Fixed size, lock-free queue for any number of producer threads and exactly one consumer thread.
+ * @details N must be a power of two, and all N slots are usable. Each slot carries a sequence number saying
+ *          whose turn it is: producers claim a slot by advancing the head with a compare-and-swap, fill it,
+ *          then publish it by bumping its sequence. The consumer only takes slots that have been published,
+ *          in order. Nobody blocks or allocates - push() fails when the queue is full and pop() when the
+ *          next slot hasn't been published yet (empty, or its producer is still writing it).
+ *          Head and tail are padded apart like SpscQueue's.
+ */
+template <typename T, uint32_t N>
+class MpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue size must be a power of two");
+public:
+    MpscQueue() : head(0), tail(0) {
+        for (uint32_t i = 0; i < N; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    };
+
+    /**
+     * @brief Any thread. Returns false (and drops item) when the queue is full.
+     */
+    bool push(const T& item) {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & (N - 1)];
+            int32_t turn = (int32_t) (slot.sequence.load(std::memory_order_acquire) - pos);
+            if (turn == 0) {
+                // Free for this position - claim it. On failure pos is reloaded and we go again.
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.item = item;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (turn < 0) {
+                // Still holds the item from one lap ago - full.
+                return false;
+            }
+            else {
+                // Another producer got this position first.
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief Consumer only. Returns false when the next item isn't there (yet).
+     */
+    bool pop(T& item) {
+        uint32_t pos = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & (N - 1)];
+        if ((int32_t) (slot.sequence.load(std::memory_order_acquire) - (pos + 1)) < 0)
+            return false;
+        item = slot.item;
+        // Free again for the producer one lap later.
+        slot.sequence.store(pos + N, std::memory_order_release);
+        tail.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    };
+
+    /**
+     * @brief Approximate while producers are pushing.
+     */
+    uint32_t size() const {
+        // Tail first: the head read after it can only be further on.
+        uint32_t t = tail.load(std::memory_order_acquire);
+        return head.load(std::memory_order_acquire) - t;
+    };
+    static uint32_t capacity() { return N; };
+
+protected:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        T item;
+    };
+
+    std::atomic<uint32_t> head;
+    uint8_t headPad[SPSC_QUEUE_PAD - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> tail;
+    uint8_t tailPad[SPSC_QUEUE_PAD - sizeof(std::atomic<uint32_t>)];
+    Slot slots[N];
+};
@@ -0,0 +1,364 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "PoolAllocator.h"
+#include <cstdio>
+#include <cstring>
+
+alignas(16) static uint8_t arena[POOL_ALLOC_ARENA_SIZE];
+static bool initialized = false;
+static uint32_t allocs = 0, frees = 0, failures = 0;
+
+////////////////////////////////////////
+//
+//  Size-class pools - a free list per class, chunks are handed out untouched until first used
+//
+////////////////////////////////////////
+
+struct Pool {
+    uint8_t* base;
+    uint32_t chunk;
+    uint32_t count;
+    uint32_t touched;       // chunks ever handed out - the rest have never been on the free list
+    void* freeList;
+    uint32_t inUse;
+    uint32_t peak;
+    uint32_t fallbacks;
+};
+
+static Pool pools[POOL_ALLOC_CLASSES];
+static uint8_t* poolsEnd;
+
+static void* poolTake(Pool& p) {
+    void* ptr;
+    if (p.freeList) {
+        ptr = p.freeList;
+        p.freeList = *(void**)ptr;
+    }
+    else if (p.touched < p.count) {
+        ptr = p.base + p.touched++ * p.chunk;
+    }
+    else {
+        p.fallbacks++;
+        return nullptr;
+    }
+
+    if (++p.inUse > p.peak)
+        p.peak = p.inUse;
+    return ptr;
+}
+
+static Pool* poolOwning(void* ptr) {
+    if ((uint8_t*)ptr < arena || (uint8_t*)ptr >= poolsEnd)
+        return nullptr;
+    for (int i = POOL_ALLOC_CLASSES - 1; i >= 0; i--) {
+        if ((uint8_t*)ptr >= pools[i].base)
+            return &pools[i];
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////
+//
+//  TLSF - first level picks the power of two, second level splits it into 16 linear ranges
+//
+////////////////////////////////////////
+
+#define ALIGN_LOG   3
+#define ALIGN       (1U << ALIGN_LOG)
+#define SL_LOG      4
+#define SL_COUNT    (1U << SL_LOG)
+#define FL_SHIFT    (SL_LOG + ALIGN_LOG)
+#define SMALL_BLOCK (1U << FL_SHIFT)    // below this everything lives in first level 0
+#define FL_COUNT    (32 - FL_SHIFT + 1)
+#define FREE_BIT    ((size_t)1)
+
+struct Block {
+    Block* prevPhys;        // physically previous block, nullptr for the first one
+    size_t size;            // payload bytes, FREE_BIT set while free
+    Block* nextFree;        // free list links live in the payload of free blocks
+    Block* prevFree;
+};
+
+#define HDR          offsetof(Block, nextFree)
+#define MIN_PAYLOAD  (sizeof(Block) - HDR)
+
+static Block* heads[FL_COUNT][SL_COUNT];
+static uint32_t flBitmap;
+static uint32_t slBitmap[FL_COUNT];
+static size_t tlsfFree, tlsfUsed;
+
+static inline int highBit(size_t v) { return (int)(sizeof(unsigned long) * 8 - 1 - __builtin_clzl((unsigned long)v)); }
+static inline int lowBit(uint32_t v) { return __builtin_ctz(v); }
+
+static inline size_t blockSize(const Block* b) { return b->size & ~FREE_BIT; }
+static inline bool isFree(const Block* b) { return b->size & FREE_BIT; }
+static inline Block* nextPhys(Block* b) { return (Block*)((uint8_t*)b + HDR + blockSize(b)); }
+static inline void* payload(Block* b) { return (uint8_t*)b + HDR; }
+static inline Block* fromPayload(void* p) { return (Block*)((uint8_t*)p - HDR); }
+
+static void mapping(size_t size, int& fl, int& sl) {
+    if (size < SMALL_BLOCK) {
+        fl = 0;
+        sl = (int)(size >> ALIGN_LOG);
+    }
+    else {
+        int t = highBit(size);
+        sl = (int)((size >> (t - SL_LOG)) ^ SL_COUNT);
+        fl = t - (FL_SHIFT - 1);
+    }
+}
+
+static void insertFree(Block* b) {
+    int fl, sl;
+    mapping(blockSize(b), fl, sl);
+    b->prevFree = nullptr;
+    b->nextFree = heads[fl][sl];
+    if (b->nextFree)
+        b->nextFree->prevFree = b;
+    heads[fl][sl] = b;
+    flBitmap |= 1U << fl;
+    slBitmap[fl] |= 1U << sl;
+    tlsfFree += blockSize(b);
+}
+
+static void removeFree(Block* b) {
+    int fl, sl;
+    mapping(blockSize(b), fl, sl);
+    if (b->prevFree)
+        b->prevFree->nextFree = b->nextFree;
+    else
+        heads[fl][sl] = b->nextFree;
+    if (b->nextFree)
+        b->nextFree->prevFree = b->prevFree;
+
+    if (!heads[fl][sl]) {
+        slBitmap[fl] &= ~(1U << sl);
+        if (!slBitmap[fl])
+            flBitmap &= ~(1U << fl);
+    }
+    tlsfFree -= blockSize(b);
+}
+
+static Block* tlsfTake(size_t size) {
+    size = (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+    if (size < MIN_PAYLOAD)
+        size = MIN_PAYLOAD;
+
+    // Round up to the next list boundary so any block found is guaranteed to fit (good fit, not best fit).
+    size_t search = size;
+    if (search >= SMALL_BLOCK)
+        search += ((size_t)1 << (highBit(search) - SL_LOG)) - 1;
+    int fl, sl;
+    mapping(search, fl, sl);
+    if (fl >= FL_COUNT)
+        return nullptr;
+
+    uint32_t slMap = slBitmap[fl] & (~0U << sl);
+    if (!slMap) {
+        uint32_t flMap = fl + 1 < 32 ? flBitmap & (~0U << (fl + 1)) : 0;
+        if (!flMap)
+            return nullptr;
+        fl = lowBit(flMap);
+        slMap = slBitmap[fl];
+    }
+    Block* b = heads[fl][lowBit(slMap)];
+    removeFree(b);
+
+    // Split off the tail if it can hold a block of its own.
+    if (blockSize(b) >= size + HDR + MIN_PAYLOAD) {
+        Block* rest = (Block*)((uint8_t*)payload(b) + size);
+        rest->size = (blockSize(b) - size - HDR) | FREE_BIT;
+        rest->prevPhys = b;
+        nextPhys(rest)->prevPhys = rest;
+        b->size = size;
+        insertFree(rest);
+    }
+    b->size &= ~FREE_BIT;
+    tlsfUsed += blockSize(b);
+    return b;
+}
+
+static void tlsfGive(Block* b) {
+    tlsfUsed -= blockSize(b);
+    b->size |= FREE_BIT;
+
+    Block* prev = b->prevPhys;
+    if (prev && isFree(prev)) {
+        removeFree(prev);
+        prev->size = (blockSize(prev) + HDR + blockSize(b)) | FREE_BIT;
+        b = prev;
+        nextPhys(b)->prevPhys = b;
+    }
+    Block* next = nextPhys(b);
+    if (isFree(next)) {
+        removeFree(next);
+        b->size = (blockSize(b) + HDR + blockSize(next)) | FREE_BIT;
+        nextPhys(b)->prevPhys = b;
+    }
+    insertFree(b);
+}
+
+static size_t tlsfLargestFree() {
+    if (!flBitmap)
+        return 0;
+    int fl = highBit(flBitmap);
+    size_t largest = 0;
+    for (Block* b = heads[fl][highBit(slBitmap[fl])]; b; b = b->nextFree) {
+        if (blockSize(b) > largest)
+            largest = blockSize(b);
+    }
+    return largest;
+}
+
+static void init() {
+    // Pools first (a quarter of the arena, split evenly by bytes), then one big TLSF block.
+    uint8_t* cursor = arena;
+    const size_t share = POOL_ALLOC_ARENA_SIZE / 4 / POOL_ALLOC_CLASSES;
+    for (int i = 0; i < POOL_ALLOC_CLASSES; i++) {
+        Pool& p = pools[i];
+        memset(&p, 0, sizeof(p));
+        p.chunk = 16U << i;
+        p.count = share / p.chunk;
+        p.base = cursor;
+        cursor += p.count * p.chunk;
+    }
+    poolsEnd = cursor;
+
+    Block* first = (Block*)cursor;
+    Block* sentinel = (Block*)(arena + ((POOL_ALLOC_ARENA_SIZE - HDR) & ~(size_t)(ALIGN - 1)));
+    first->prevPhys = nullptr;
+    first->size = ((uint8_t*)sentinel - (uint8_t*)payload(first)) | FREE_BIT;
+    sentinel->prevPhys = first;
+    sentinel->size = 0;     // zero sized and never free, so merging stops here
+    insertFree(first);
+
+    initialized = true;
+}
+
+////////////////////////////////////////
+//
+//  Public API
+//
+////////////////////////////////////////
+
+void* poolAlloc(size_t size) {
+    if (!initialized)
+        init();
+    allocs++;
+
+    for (int i = 0; i < POOL_ALLOC_CLASSES; i++) {
+        if (size <= pools[i].chunk) {
+            void* ptr = poolTake(pools[i]);
+            if (ptr)
+                return ptr;
+            break;
+        }
+    }
+
+    Block* b = tlsfTake(size);
+    if (!b) {
+        failures++;
+        return nullptr;
+    }
+    return payload(b);
+}
+
+void poolFree(void* ptr) {
+    if (!ptr)
+        return;
+    frees++;
+
+    Pool* p = poolOwning(ptr);
+    if (p) {
+        *(void**)ptr = p->freeList;
+        p->freeList = ptr;
+        p->inUse--;
+        return;
+    }
+    tlsfGive(fromPayload(ptr));
+}
+
+void* poolRealloc(void* ptr, size_t size) {
+    if (!ptr)
+        return poolAlloc(size);
+    if (!size) {
+        poolFree(ptr);
+        return nullptr;
+    }
+
+    Pool* p = poolOwning(ptr);
+    size_t have = p ? p->chunk : blockSize(fromPayload(ptr));
+    if (size <= have)
+        return ptr;
+
+    void* grown = poolAlloc(size);
+    if (!grown)
+        return nullptr;
+    memcpy(grown, ptr, have);
+    poolFree(ptr);
+    return grown;
+}
+
+void poolAllocGetStats(PoolAllocStats* stats) {
+    if (!initialized)
+        init();
+
+    memset(stats, 0, sizeof(*stats));
+    stats->arenaSize = POOL_ALLOC_ARENA_SIZE;
+    stats->used = tlsfUsed;
+    stats->free = tlsfFree;
+    for (int i = 0; i < POOL_ALLOC_CLASSES; i++) {
+        const Pool& p = pools[i];
+        PoolClassStats& c = stats->classes[i];
+        c.chunkSize = p.chunk;
+        c.capacity = p.count;
+        c.inUse = p.inUse;
+        c.peak = p.peak;
+        c.fallbacks = p.fallbacks;
+        stats->used += (size_t)p.inUse * p.chunk;
+        stats->free += (size_t)(p.count - p.inUse) * p.chunk;
+    }
+    stats->largestFree = tlsfLargestFree();
+    stats->fragmentationPct = tlsfFree ? 100.0f * (1.0f - (float)stats->largestFree / tlsfFree) : 0.0f;
+    stats->allocs = allocs;
+    stats->frees = frees;
+    stats->failures = failures;
+}
+
+void poolAllocPrintStats(void) {
+    PoolAllocStats s;
+    poolAllocGetStats(&s);
+    printf("Pool allocator: %u used, %u free, largest free %u, fragmentation %.1f%%, %u allocs, %u frees, %u failed\n",
+           (unsigned)s.used, (unsigned)s.free, (unsigned)s.largestFree, s.fragmentationPct,
+           s.allocs, s.frees, s.failures);
+    for (int i = 0; i < POOL_ALLOC_CLASSES; i++) {
+        const PoolClassStats& c = s.classes[i];
+        printf("  %4u byte chunks: %u/%u in use, peak %u, %u fell back to TLSF\n",
+               c.chunkSize, c.inUse, c.capacity, c.peak, c.fallbacks);
+    }
+}
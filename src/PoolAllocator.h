@@ -0,0 +1,87 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+//
+// Deterministic heap for LVGL: size-class pools for the many small objects (styles, event
+// descriptors, object attributes) plus a TLSF (two-level segregated fit) allocator for everything
+// else, both inside one fixed arena. Every call is O(1) and the arena cannot be fragmented by other
+// heap users. Enabled with POOL_ALLOCATOR=1 - see lv_conf.h and platformio.ini.
+//
+// This header is included by LVGL's C sources (LV_MEM_CUSTOM_INCLUDE), so it has to stay plain C.
+// Not thread safe - like all of LVGL, only call it while holding the LVGL mutex.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef POOL_ALLOC_ARENA_SIZE
+#ifdef ESP_PLATFORM
+#define POOL_ALLOC_ARENA_SIZE (64U * 1024U)
+#else
+#define POOL_ALLOC_ARENA_SIZE (8U * 1024U * 1024U)
+#endif
+#endif
+
+// Chunk sizes 16, 32, 64 and 128 bytes. Together the pools take a quarter of the arena.
+#define POOL_ALLOC_CLASSES 4
+
+typedef struct {
+    uint32_t chunkSize;
+    uint32_t capacity;      // chunks
+    uint32_t inUse;
+    uint32_t peak;
+    uint32_t fallbacks;     // requests passed on to TLSF because the pool was full
+} PoolClassStats;
+
+typedef struct {
+    size_t arenaSize;
+    size_t used;            // bytes handed out (pool chunks + TLSF block payloads)
+    size_t free;
+    size_t largestFree;     // biggest single TLSF allocation that would succeed right now
+    float fragmentationPct; // 100 * (1 - largestFree / TLSF free bytes)
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failures;
+    PoolClassStats classes[POOL_ALLOC_CLASSES];
+} PoolAllocStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* poolAlloc(size_t size);
+void poolFree(void* ptr);
+void* poolRealloc(void* ptr, size_t size);
+
+void poolAllocGetStats(PoolAllocStats* stats);
+void poolAllocPrintStats(void);
+
+#ifdef __cplusplus
+}
+#endif
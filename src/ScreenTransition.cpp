@@ -0,0 +1,186 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "ScreenTransition.h"
+#include "BootProfiler.h"
+#include <cstdlib>
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+lv_obj_t* ScreenTransition::stage = nullptr;
+lv_obj_t* ScreenTransition::target = nullptr;
+lv_scr_load_anim_t ScreenTransition::type = LV_SCR_LOAD_ANIM_NONE;
+lv_coord_t ScreenTransition::width = 0;
+lv_coord_t ScreenTransition::height = 0;
+ScreenTransition::Snapshot ScreenTransition::outgoing = {};
+ScreenTransition::Snapshot ScreenTransition::incoming = {};
+uint32_t ScreenTransition::budget = SCREEN_TRANSITION_BUDGET;
+ScreenTransitionStats ScreenTransition::stats = {};
+
+static bool supported(lv_scr_load_anim_t anim) {
+    switch (anim) {
+        case LV_SCR_LOAD_ANIM_OVER_LEFT:
+        case LV_SCR_LOAD_ANIM_OVER_RIGHT:
+        case LV_SCR_LOAD_ANIM_OVER_TOP:
+        case LV_SCR_LOAD_ANIM_OVER_BOTTOM:
+        case LV_SCR_LOAD_ANIM_MOVE_LEFT:
+        case LV_SCR_LOAD_ANIM_MOVE_RIGHT:
+        case LV_SCR_LOAD_ANIM_MOVE_TOP:
+        case LV_SCR_LOAD_ANIM_MOVE_BOTTOM:
+        case LV_SCR_LOAD_ANIM_FADE_ON:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ScreenTransition::start(lv_obj_t* to, lv_scr_load_anim_t anim, uint32_t timeMS) {
+    if (isRunning())
+        finish();
+    lv_obj_t* from = lv_scr_act();
+    if (!to || to == from || !timeMS || !supported(anim))
+        return false;
+
+    // The incoming screen may never have been shown - lay it out so the snapshot matches the real thing.
+    lv_obj_update_layout(to);
+    uint32_t needed = lv_snapshot_buf_size_needed(from, LV_IMG_CF_TRUE_COLOR) +
+                      lv_snapshot_buf_size_needed(to, LV_IMG_CF_TRUE_COLOR);
+    bool fits = needed <= budget;
+#ifdef ESP_PLATFORM
+    fits = fits && heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) >= needed + SCREEN_TRANSITION_RESERVE;
+#endif
+    if (!fits) {
+        stats.fallbacks++;
+        return false;
+    }
+
+    uint32_t startUS = BootProfiler::nowUS();
+    if (!take(from, outgoing) || !take(to, incoming)) {
+        release(outgoing);
+        release(incoming);
+        stats.fallbacks++;
+        return false;
+    }
+    stats.snapshotUS = BootProfiler::nowUS() - startUS;
+    stats.bytes = needed;
+    stats.snapshotted++;
+
+    width = lv_obj_get_width(from);
+    height = lv_obj_get_height(from);
+    target = to;
+    type = anim;
+
+    // Nothing on the stage but the two images, so nothing else is drawn while they move.
+    stage = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(stage, lv_color_black(), 0);
+    lv_obj_clear_flag(stage, LV_OBJ_FLAG_SCROLLABLE);
+    outgoing.img = lv_img_create(stage);
+    lv_img_set_src(outgoing.img, &outgoing.dsc);
+    incoming.img = lv_img_create(stage);
+    lv_img_set_src(incoming.img, &incoming.dsc);
+    animate(stage, 0);
+    lv_scr_load(stage);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, stage);
+    lv_anim_set_exec_cb(&a, animate);
+    lv_anim_set_values(&a, 0, anim == LV_SCR_LOAD_ANIM_FADE_ON ? LV_OPA_COVER : 1024);
+    lv_anim_set_time(&a, timeMS);
+    lv_anim_set_ready_cb(&a, animDone);
+    lv_anim_start(&a);
+    return true;
+}
+
+void ScreenTransition::activate(lvppScreen* screen, uint32_t timeMS, lv_scr_load_anim_t anim) {
+    if (!start(screen->getScreen(), anim, timeMS))
+        screen->activateScreen(timeMS, anim);
+}
+
+bool ScreenTransition::take(lv_obj_t* screen, Snapshot& snap) {
+    uint32_t size = lv_snapshot_buf_size_needed(screen, LV_IMG_CF_TRUE_COLOR);
+    snap.buffer = (uint8_t*) malloc(size);
+    if (!snap.buffer)
+        return false;
+    return lv_snapshot_take_to_buf(screen, LV_IMG_CF_TRUE_COLOR, &snap.dsc, snap.buffer, size) == LV_RES_OK;
+}
+
+void ScreenTransition::release(Snapshot& snap) {
+    if (snap.buffer) {
+        lv_img_cache_invalidate_src(&snap.dsc);
+        free(snap.buffer);
+    }
+    snap.buffer = nullptr;
+    snap.img = nullptr;
+}
+
+// progress is 0-1024 for the moves and 0-255 (the incoming opacity) for the fade.
+void ScreenTransition::animate(void* var, int32_t progress) {
+    (void) var;
+    const lv_coord_t dx = width - width * progress / 1024;
+    const lv_coord_t dy = height - height * progress / 1024;
+    lv_coord_t inX = 0, inY = 0, outX = 0, outY = 0;
+
+    switch (type) {
+        case LV_SCR_LOAD_ANIM_OVER_LEFT:    inX = dx; break;
+        case LV_SCR_LOAD_ANIM_OVER_RIGHT:   inX = -dx; break;
+        case LV_SCR_LOAD_ANIM_OVER_TOP:     inY = dy; break;
+        case LV_SCR_LOAD_ANIM_OVER_BOTTOM:  inY = -dy; break;
+        case LV_SCR_LOAD_ANIM_MOVE_LEFT:    inX = dx;  outX = dx - width; break;
+        case LV_SCR_LOAD_ANIM_MOVE_RIGHT:   inX = -dx; outX = width - dx; break;
+        case LV_SCR_LOAD_ANIM_MOVE_TOP:     inY = dy;  outY = dy - height; break;
+        case LV_SCR_LOAD_ANIM_MOVE_BOTTOM:  inY = -dy; outY = height - dy; break;
+        case LV_SCR_LOAD_ANIM_FADE_ON:
+            lv_obj_set_style_opa(incoming.img, (lv_opa_t) progress, 0);
+            break;
+        default:
+            break;
+    }
+    lv_obj_set_pos(outgoing.img, outX, outY);
+    lv_obj_set_pos(incoming.img, inX, inY);
+}
+
+void ScreenTransition::animDone(lv_anim_t* a) {
+    (void) a;
+    finish();
+}
+
+void ScreenTransition::finish() {
+    if (!stage)
+        return;
+    lv_obj_t* done = stage;
+    stage = nullptr;
+
+    lv_anim_del(done, animate);
+    lv_scr_load(target);
+    lv_obj_del(done);
+    release(outgoing);
+    release(incoming);
+    target = nullptr;
+}
@@ -0,0 +1,105 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+
+// Most bytes the two transition snapshots may take together. Above that (or if the memory isn't there)
+// the transition falls back to LVGL's own live animation. Two 16-bit 320x240 snapshots are 300KB, so
+// on the ESP32 this needs PSRAM.
+#ifndef SCREEN_TRANSITION_BUDGET
+#define SCREEN_TRANSITION_BUDGET (2U * SDL_HOR_RES * SDL_VER_RES * sizeof(lv_color_t))
+#endif
+
+// Memory left free for everyone else after the snapshots are allocated (ESP32 only).
+#ifndef SCREEN_TRANSITION_RESERVE
+#define SCREEN_TRANSITION_RESERVE (32U * 1024U)
+#endif
+
+struct ScreenTransitionStats {
+    uint32_t snapshotted;       // transitions run from snapshots
+    uint32_t fallbacks;         // transitions handed to lv_scr_load_anim()
+    uint32_t snapshotUS;        // time spent taking the last pair of snapshots
+    uint32_t bytes;             // size of the last pair of snapshots
+};
+
+/**
+ * @brief Screen load animations which move two bitmaps instead of two live widget trees.
+ * @details lv_scr_load_anim() redraws both screens, every widget, on every animation frame. Here the
+ *          outgoing and incoming screens are rendered once each into a snapshot, an empty stage screen
+ *          showing the two images is loaded, and the animation just moves (or fades) the images. At the
+ *          end the live incoming screen is loaded. Frame cost is then two image blits no matter how
+ *          complex the screens are.
+ *
+ *          The stage screen is what gets the unload/load events in between, so the outgoing screen sees
+ *          SCREEN_UNLOADED at the start and the incoming one LOAD_START at the end.
+ */
+class ScreenTransition {
+public:
+    /**
+     * @brief Runs a snapshot transition to 'to'.
+     * @return false if it didn't start (no animation, unsupported type, over budget, snapshot failed) -
+     *         the caller should then load the screen its usual way.
+     */
+    static bool start(lv_obj_t* to, lv_scr_load_anim_t anim, uint32_t timeMS);
+
+    /**
+     * @brief start(), falling back to screen->activateScreen(timeMS, anim).
+     */
+    static void activate(lvppScreen* screen, uint32_t timeMS, lv_scr_load_anim_t anim);
+
+    static bool isRunning() { return stage != nullptr; };
+
+    /**
+     * @brief Ends a running transition right away, with the incoming screen loaded.
+     */
+    static void finish();
+
+    static void setBudget(uint32_t bytes) { budget = bytes; };
+    static const ScreenTransitionStats& getStats() { return stats; };
+
+protected:
+    struct Snapshot {
+        lv_img_dsc_t dsc;
+        uint8_t* buffer;
+        lv_obj_t* img;
+    };
+
+    static bool take(lv_obj_t* screen, Snapshot& snap);
+    static void release(Snapshot& snap);
+    static void animate(void* var, int32_t value);
+    static void animDone(lv_anim_t* a);
+
+    static lv_obj_t* stage;
+    static lv_obj_t* target;
+    static lv_scr_load_anim_t type;
+    static lv_coord_t width, height;
+    static Snapshot outgoing, incoming;
+    static uint32_t budget;
+    static ScreenTransitionStats stats;
+};
@@ -0,0 +1,234 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#ifndef ESP_PLATFORM
+#include "SensorSim.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+std::atomic<SensorSim*> SensorSim::active(nullptr);
+
+static uint64_t steadyNowUS() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SensorSim::SensorSim(uint32_t windowMS) : RoboTask("SensorSim", 2) {
+    windowNS = (uint64_t) windowMS * 1000000;
+    windowEndNS = windowNS;
+    originUS = 0;
+    started = false;
+    resetStats();
+    setBaseRunDelay(SENSOR_SIM_PERIOD_MS);
+}
+
+SensorSim::~SensorSim() {
+    // Stop the task before the sensors go - ~RoboTask() would only do it after.
+    Terminate();
+    SensorSim* self = this;
+    active.compare_exchange_strong(self, nullptr);
+}
+
+void SensorSim::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+TelemetryKey SensorSim::keyFor(const std::string& name, float start) {
+    TelemetryKey key = Telemetry::find(name.c_str());
+    if (key != TELEMETRY_NONE)
+        return key;
+    // Telemetry keeps the name pointer, and sensors are added once, so the copy lives for good.
+    return Telemetry::addValue(strdup(name.c_str()), start);
+}
+
+uint16_t SensorSim::add(const char* name, float rateHz, const SensorModel& model, Decimation mode, uint32_t seed) {
+    Sensor s;
+    memset(&s, 0, sizeof(s));
+    s.model = model;
+    s.mode = mode;
+    s.periodS = 1.0f / rateHz;
+    s.periodNS = (uint64_t)(1e9 / rateHz);
+    s.nextNS = 0;
+    s.value = model.start;
+    s.direction = 1.0f;
+    s.rng = seed * 2654435761u | 1;
+    s.key = keyFor(name, model.start);
+    s.minKey = s.maxKey = TELEMETRY_NONE;
+    if (mode == Decimation::MinMax) {
+        s.minKey = keyFor(std::string(name) + ".min", model.start);
+        s.maxKey = keyFor(std::string(name) + ".max", model.start);
+    }
+    if (s.key == TELEMETRY_NONE)
+        printf("SensorSim: '%s' has no telemetry value - it will not be published.\n", name);
+    sensors.push_back(s);
+    // Before the task runs, so TheBrain stops writing these values before the simulation does.
+    active.store(this);
+    return (uint16_t)(sensors.size() - 1);
+}
+
+////////////////////////////////////////
+//
+//  S i g n a l   m o d e l
+//
+////////////////////////////////////////
+
+uint32_t SensorSim::xorshift(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+float SensorSim::uniform(uint32_t& state) {
+    return (xorshift(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+float SensorSim::gaussian(uint32_t& state) {
+    // Sum of four uniforms (Irwin-Hall), scaled to a standard deviation of 1. Close enough to a normal
+    // distribution for sensor noise, and no log/sqrt/cos per sample at 10 kHz.
+    float sum = uniform(state) + uniform(state) + uniform(state) + uniform(state);
+    return (sum - 2.0f) * 1.7320508f;
+}
+
+float SensorSim::sample(Sensor& s) {
+    const SensorModel& m = s.model;
+
+    s.value += s.direction * m.driftPerS * s.periodS;
+    if (m.stepsPerS > 0.0f && uniform(s.rng) < m.stepsPerS * s.periodS)
+        s.value += (xorshift(s.rng) & 1) ? m.stepSize : -m.stepSize;
+    // Drift turns back at either bound, whichever way it started.
+    if (s.value >= m.high) {
+        s.value = m.high;
+        if (s.direction * m.driftPerS > 0.0f)
+            s.direction = -s.direction;
+    }
+    else if (s.value <= m.low) {
+        s.value = m.low;
+        if (s.direction * m.driftPerS < 0.0f)
+            s.direction = -s.direction;
+    }
+
+    return m.noise > 0.0f ? s.value + m.noise * gaussian(s.rng) : s.value;
+}
+
+////////////////////////////////////////
+//
+//  D e c i m a t i o n
+//
+////////////////////////////////////////
+
+void SensorSim::produceUntil(uint64_t untilNS) {
+    for (Sensor& s : sensors) {
+        while (s.nextNS < untilNS) {
+            float v = sample(s);
+            if (!s.n) {
+                s.sum = 0.0;
+                s.minimum = s.maximum = v;
+            }
+            s.sum += v;
+            if (v < s.minimum)
+                s.minimum = v;
+            if (v > s.maximum)
+                s.maximum = v;
+            s.last = v;
+            s.n++;
+            s.nextNS += s.periodNS;
+            stats.samples++;
+        }
+    }
+}
+
+void SensorSim::publishValue(Telemetry::Batch& batch, TelemetryKey key, float v) {
+    if (key == TELEMETRY_NONE)
+        return;
+    if (Telemetry::getType(key) == TelemetryType::Int)
+        batch.setInt(key, (int32_t) lroundf(v));
+    else
+        batch.setFloat(key, v);
+}
+
+void SensorSim::publish(Sensor& s, Telemetry::Batch& batch) {
+    // Slower than the window (a 1 Hz sensor, say): nothing new, the last published value stands.
+    if (!s.n)
+        return;
+
+    float mean = (float)(s.sum / s.n);
+    switch (s.mode) {
+    case Decimation::Average:
+        publishValue(batch, s.key, mean);
+        break;
+    case Decimation::Min:
+        publishValue(batch, s.key, s.minimum);
+        break;
+    case Decimation::Max:
+        publishValue(batch, s.key, s.maximum);
+        break;
+    case Decimation::MinMax:
+        publishValue(batch, s.key, mean);
+        publishValue(batch, s.minKey, s.minimum);
+        publishValue(batch, s.maxKey, s.maximum);
+        break;
+    case Decimation::Last:
+        publishValue(batch, s.key, s.last);
+        break;
+    }
+    s.n = 0;
+    stats.windows++;
+}
+
+void SensorSim::step(uint64_t nowUS) {
+    if (!started) {
+        started = true;
+        originUS = nowUS;
+    }
+    uint64_t nowNS = (nowUS - originUS) * 1000;
+
+    // Every window that closed: its samples, then all sensors' values in one batch, so a snapshot
+    // never mixes two windows.
+    while (windowEndNS <= nowNS) {
+        produceUntil(windowEndNS);
+        {
+            Telemetry::Batch batch;
+            for (Sensor& s : sensors)
+                publish(s, batch);
+        }
+        windowEndNS += windowNS;
+    }
+    // And what is due so far of the open one.
+    produceUntil(nowNS + 1);
+}
+
+void SensorSim::Run() {
+    uint64_t now = steadyNowUS();
+    step(now);
+    stats.lagUS = (uint32_t)(steadyNowUS() - now);
+    if (stats.lagUS > stats.maxLagUS)
+        stats.maxLagUS = stats.lagUS;
+}
+#endif
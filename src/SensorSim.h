@@ -0,0 +1,157 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#ifndef ESP_PLATFORM
+#include "lvpp.h"
+#include "robotask.h"
+#include "Telemetry.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How often the simulation task wakes up to produce the samples that came due. Higher rates are
+// produced in blocks, the way an ADC with DMA hands them over.
+#ifndef SENSOR_SIM_PERIOD_MS
+#define SENSOR_SIM_PERIOD_MS 2
+#endif
+
+/**
+ * @brief How a simulated signal behaves. All values in the sensor's unit.
+ */
+struct SensorModel {
+    float start;            // initial value
+    float noise;            // standard deviation of the white noise on every sample
+    float driftPerS;        // linear drift, reversing at low/high
+    float stepSize;         // size of a sudden step (random sign)
+    float stepsPerS;        // mean rate of steps (0 = none)
+    float low;              // the signal stays within [low, high]
+    float high;
+};
+
+enum class Decimation : uint8_t {
+    Average,                // mean of the window
+    Min,
+    Max,
+    MinMax,                 // mean into <name>, extremes into <name>.min and <name>.max
+    Last,                   // latest sample only
+};
+
+struct SensorStats {
+    uint64_t samples;       // produced
+    uint64_t windows;       // decimated values published
+    uint32_t lagUS;         // time the task's last step took - beyond SENSOR_SIM_PERIOD_MS it can't keep up
+    uint32_t maxLagUS;
+};
+
+/**
+ * @brief Simulated sensors at real sample rates (1 Hz to 10 kHz and up), decimated to display rate and
+ *        published to the Telemetry store.
+ * @details Native only - a load test of the data path on a laptop. Every sensor produces its samples at
+ *          exact timestamps from a model with noise, drift and steps. The samples are reduced per
+ *          display window (Average, Min, Max, MinMax or Last), and each closed window is published to
+ *          its Telemetry value. Int values are rounded, so an existing key like TheBrain's "temperature"
+ *          can be fed directly. The UI then sees one value per window whatever the sample rate.
+ *
+ *          Start() runs the simulation on its own task, catching up on every sample due since its last
+ *          wake-up. Benchmarks leave the task paused and call step() with their own clock. Each sensor
+ *          has its own seeded generator, so a scripted run is repeatable.
+ */
+class SensorSim : public RoboTask {
+public:
+    /**
+     * @param windowMS Decimation window - the rate the UI is updated at.
+     */
+    SensorSim(uint32_t windowMS = LV_DISP_DEF_REFR_PERIOD);
+    ~SensorSim();
+
+    /**
+     * @return Index of the sensor. Add all sensors before the first step() (or Start()). The first one added
+     *         makes this the running() simulation.
+     */
+    uint16_t add(const char* name, float rateHz, const SensorModel& model, Decimation mode, uint32_t seed = 1);
+
+    /**
+     * @brief Produces every sample due up to nowUS (microseconds on the caller's clock, starting anywhere).
+     */
+    void step(uint64_t nowUS);
+    void Run();
+
+    uint16_t count() const { return (uint16_t) sensors.size(); };
+    TelemetryKey getKey(uint16_t sensor) const { return sensors[sensor].key; };
+    const SensorStats& getStats() const { return stats; };
+    void resetStats();
+
+    /**
+     * @brief The running simulation, if there is one - TheBrain leaves the simulated values to it.
+     */
+    static SensorSim* running() { return active.load(); };
+
+protected:
+    struct Sensor {
+        SensorModel model;
+        Decimation mode;
+        float periodS;
+        uint64_t periodNS;      // between samples
+        uint64_t nextNS;        // timestamp of the next sample
+        float value;            // noise-free signal
+        float direction;        // +1 / -1 drift
+        uint32_t rng;
+        TelemetryKey key;
+        TelemetryKey minKey;
+        TelemetryKey maxKey;
+
+        // Window being accumulated
+        double sum;
+        float minimum;
+        float maximum;
+        float last;
+        uint32_t n;
+    };
+
+    float sample(Sensor& s);
+    void produceUntil(uint64_t untilNS);
+    void publish(Sensor& s, Telemetry::Batch& batch);
+    static void publishValue(Telemetry::Batch& batch, TelemetryKey key, float v);
+    static TelemetryKey keyFor(const std::string& name, float start);
+    static uint32_t xorshift(uint32_t& state);
+    static float uniform(uint32_t& state);
+    static float gaussian(uint32_t& state);
+
+    std::vector<Sensor> sensors;
+    uint64_t windowNS;
+    uint64_t windowEndNS;
+    uint64_t originUS;          // step()'s clock at the first call
+    bool started;
+    SensorStats stats;
+
+    // Read by TheBrain's task, set by add() on the thread building the simulation.
+    static std::atomic<SensorSim*> active;
+};
+#endif
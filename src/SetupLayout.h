@@ -0,0 +1,38 @@
+// Generated by support/layout_compiler.py from layouts/setup.json - do not edit.
+#pragma once
+
+#include <cstdint>
+
+alignas(4) static const uint8_t setupLayout[488] = {
+    0x4c, 0x56, 0x50, 0x4c, 0x01, 0x00, 0x09, 0x00, 0x60, 0x00, 0x00, 0x00, 0x14, 0x00, 0x0a, 0x00,
+    0x50, 0x01, 0x00, 0x00, 0xe8, 0x01, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x00,
+    0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x00,
+    0x02, 0x00, 0x04, 0x00, 0xff, 0xff, 0x05, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x00,
+    0x03, 0x00, 0x07, 0x00, 0xff, 0xff, 0x04, 0x00, 0x02, 0x00, 0x08, 0x00, 0x09, 0x00, 0x02, 0x00,
+    0x2b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x28, 0x00, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x02, 0x01, 0x09, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x2a, 0x00, 0x00, 0x00, 0x01, 0x02, 0x0f, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x09, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xc4, 0xff, 0xff, 0xff, 0x07, 0x00, 0x02, 0x00, 0x00, 0x00, 0x05, 0x01,
+    0x00, 0x00, 0x0d, 0x01, 0x2b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x03, 0x00, 0x05, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x02, 0x00, 0x00, 0x00, 0x06, 0x01,
+    0x00, 0x00, 0x0a, 0x01, 0x0c, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00,
+    0x0d, 0x00, 0x00, 0x00, 0x02, 0x01, 0x05, 0x01, 0x00, 0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00,
+    0x01, 0x02, 0x08, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0xfb, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00,
+    0x07, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0d, 0x01, 0x00, 0x00, 0x04, 0x01, 0x09, 0x00, 0x00, 0x00,
+    0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0xfd, 0xff, 0xff, 0xff,
+    0xfd, 0xff, 0xff, 0xff, 0x10, 0x00, 0x00, 0x00, 0x96, 0x7d, 0x81, 0x6e, 0x00, 0x00, 0x00, 0x00,
+    0x78, 0x01, 0x00, 0x00, 0x7e, 0x01, 0x00, 0x00, 0x93, 0x01, 0x00, 0x00, 0x98, 0x01, 0x00, 0x00,
+    0xaf, 0x01, 0x00, 0x00, 0xb4, 0x01, 0x00, 0x00, 0xc0, 0x01, 0x00, 0x00, 0xcf, 0x01, 0x00, 0x00,
+    0xd9, 0x01, 0x00, 0x00, 0xe3, 0x01, 0x00, 0x00, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x00, 0x53, 0x65,
+    0x74, 0x75, 0x70, 0x20, 0x53, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x20, 0x45, 0x78, 0x61, 0x6d, 0x70,
+    0x6c, 0x65, 0x00, 0x64, 0x65, 0x66, 0x31, 0x00, 0x54, 0x65, 0x73, 0x74, 0x20, 0x32, 0x32, 0x70,
+    0x74, 0x20, 0x6f, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x2f, 0x67, 0x72, 0x65, 0x65, 0x6e, 0x00, 0x64,
+    0x65, 0x66, 0x32, 0x00, 0x42, 0x69, 0x67, 0x20, 0x44, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x00,
+    0x41, 0x64, 0x6a, 0x61, 0x63, 0x65, 0x6e, 0x74, 0x20, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x00, 0x64,
+    0x65, 0x66, 0x73, 0x6c, 0x69, 0x64, 0x65, 0x72, 0x00, 0x45, 0x78, 0x69, 0x74, 0x53, 0x65, 0x74,
+    0x75, 0x70, 0x00, 0x45, 0x78, 0x69, 0x74, 0x00,
+};
@@ -0,0 +1,134 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "ShadowLabel.h"
+#include <cassert>
+#include <cstring>
+
+static const lv_coord_t maxShadowOffset = SHADOW_LABEL_MAX_OFFSET;
+
+ShadowLabel::ShadowLabel(lv_obj_t* parent, const lv_font_t* _font, lv_coord_t _width) {
+    font = _font;
+    width = _width;
+    height = font->line_height + maxShadowOffset;
+    buffer = new uint8_t[LV_CANVAS_BUF_SIZE_TRUE_COLOR_ALPHA(width, height)];
+    assert(buffer);
+    ownsBuffer = true;
+    init(parent);
+}
+
+ShadowLabel::ShadowLabel(lv_obj_t* parent, const lv_font_t* _font, lv_coord_t _width, uint8_t* _buffer, uint32_t bufferSize) {
+    font = _font;
+    width = _width;
+    height = font->line_height + maxShadowOffset;
+    assert(_buffer && bufferSize >= LV_CANVAS_BUF_SIZE_TRUE_COLOR_ALPHA(width, height));
+    (void) bufferSize;
+    buffer = _buffer;
+    ownsBuffer = false;
+    init(parent);
+}
+
+void ShadowLabel::init(lv_obj_t* parent) {
+    textColor = lv_color_black();
+    shadowColor = lv_color_black();
+    shadowOpa = LV_OPA_40;
+    shadowDX = 1;
+    shadowDY = 1;
+    rasterCount = 0;
+
+    canvas = lv_canvas_create(parent);
+    lv_canvas_set_buffer(canvas, buffer, width, height, LV_IMG_CF_TRUE_COLOR_ALPHA);
+    lv_obj_clear_flag(canvas, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_center(canvas);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+}
+
+ShadowLabel::~ShadowLabel() {
+    lv_obj_del(canvas);
+    if (ownsBuffer)
+        delete[] buffer;
+}
+
+bool ShadowLabel::setText(const char* pText) {
+    if (!text.set(pText))
+        return false;
+    rasterize();
+    return true;
+}
+
+bool ShadowLabel::format(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    bool changed = vformat(fmt, args);
+    va_end(args);
+    return changed;
+}
+
+bool ShadowLabel::vformat(const char* fmt, va_list args) {
+    if (!text.vformat(fmt, args))
+        return false;
+    rasterize();
+    return true;
+}
+
+void ShadowLabel::setTextColor(lv_color_t color) {
+    textColor = color;
+    rasterize();
+}
+
+void ShadowLabel::setShadow(lv_color_t color, lv_opa_t opa, lv_coord_t dx, lv_coord_t dy) {
+    shadowColor = color;
+    shadowOpa = opa;
+    shadowDX = dx < -maxShadowOffset ? -maxShadowOffset : (dx > maxShadowOffset ? maxShadowOffset : dx);
+    shadowDY = dy < -maxShadowOffset ? -maxShadowOffset : (dy > maxShadowOffset ? maxShadowOffset : dy);
+    rasterize();
+}
+
+void ShadowLabel::rasterize() {
+    rasterCount++;
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+    if (text.empty())
+        return;
+
+    // Center the text in the bitmap, leaving room for the shadow on whichever side it falls.
+    lv_point_t size;
+    lv_txt_get_size(&size, text, font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    lv_coord_t x = (width - size.x) / 2;
+    lv_coord_t y = shadowDY < 0 ? -shadowDY : 0;
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = font;
+
+    dsc.color = shadowColor;
+    dsc.opa = shadowOpa;
+    lv_canvas_draw_text(canvas, x + shadowDX, y + shadowDY, width, &dsc, text);
+
+    dsc.color = textColor;
+    dsc.opa = LV_OPA_COVER;
+    lv_canvas_draw_text(canvas, x, y, width, &dsc, text);
+}
@@ -0,0 +1,102 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include "FixedText.h"
+#include <cstdint>
+
+#define SHADOW_LABEL_MAX_TEXT 48
+
+// Largest shadow offset the bitmap leaves room for.
+#define SHADOW_LABEL_MAX_OFFSET 2
+
+// Bytes of bitmap a ShadowLabel of this width needs for a font of this line height - for callers that
+// supply the buffer themselves.
+#define SHADOW_LABEL_BUF_SIZE(width, lineHeight) LV_CANVAS_BUF_SIZE_TRUE_COLOR_ALPHA(width, (lineHeight) + SHADOW_LABEL_MAX_OFFSET)
+
+/**
+ * @brief Text with a drop shadow, rendered together into one cached ARGB bitmap (an lv_canvas).
+ * @details A pair of labels (text + offset shadow) costs two text layouts, two glyph rasterizations and
+ *          an alpha-blended overdraw on every redraw. Here the text and shadow are rasterized once per
+ *          text change, and every redraw after that is a single image blit. Setting the same text again
+ *          does nothing at all - no rasterization and no invalidation.
+ */
+class ShadowLabel {
+public:
+    /**
+     * @param parent Object the label lives in. It is centered in the parent.
+     * @param width  Widest text expected. The bitmap is width x (line height + shadow offset).
+     */
+    ShadowLabel(lv_obj_t* parent, const lv_font_t* font, lv_coord_t width);
+    /**
+     * @brief As above, drawing into the caller's buffer (at least SHADOW_LABEL_BUF_SIZE(width, line height)
+     *        bytes) instead of one from the heap. The buffer must outlive the label.
+     */
+    ShadowLabel(lv_obj_t* parent, const lv_font_t* font, lv_coord_t width, uint8_t* buffer, uint32_t bufferSize);
+    ~ShadowLabel();
+
+    /**
+     * @return true if the text changed and was rasterized again.
+     */
+    bool setText(const char* pText);
+    /**
+     * @brief printf-style setText(), formatted straight into the label's own buffer - no heap.
+     * @return true if the resulting text changed and was rasterized again.
+     */
+    bool format(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    bool vformat(const char* fmt, va_list args);
+    const char* getText() const { return text.c_str(); };
+
+    void setTextColor(lv_color_t color);
+    void setShadow(lv_color_t color, lv_opa_t opa, lv_coord_t dx = 1, lv_coord_t dy = 1);
+
+    lv_obj_t* getObj() { return canvas; };
+    /**
+     * @brief How many times the bitmap has been rasterized. Handy for checking no-op updates stay no-ops.
+     */
+    uint32_t getRasterCount() const { return rasterCount; };
+
+protected:
+    void init(lv_obj_t* parent);
+    void rasterize();
+
+    lv_obj_t* canvas;
+    uint8_t* buffer;
+    bool ownsBuffer;
+    const lv_font_t* font;
+    lv_coord_t width;
+    lv_coord_t height;
+    lv_color_t textColor;
+    lv_color_t shadowColor;
+    lv_opa_t shadowOpa;
+    lv_coord_t shadowDX;
+    lv_coord_t shadowDY;
+    uint32_t rasterCount;
+    FixedText<SHADOW_LABEL_MAX_TEXT> text;
+};
@@ -0,0 +1,97 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#define SPSC_QUEUE_PAD 8
+#else
+#define SPSC_QUEUE_PAD 64
+#endif
+
+/**
+ * @brief Fixed size, lock-free queue for exactly one producer thread and one consumer thread.
+ * @details N must be a power of two; one slot stays empty, so it holds N-1 items. Neither side ever
+ *          blocks or allocates - push() fails when the queue is full and pop() when it is empty.
+ *          On native the head and tail are padded onto their own cache lines so the two threads don't
+ *          share one (padding rather than alignas, which plain new doesn't honour before C++17).
+ */
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+public:
+    SpscQueue() : head(0), tail(0) {};
+
+    /**
+     * @brief Producer only. Returns false (and drops item) when the queue is full.
+     */
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t next = (h + 1) & (N - 1);
+        if (next == tail.load(std::memory_order_acquire))
+            return false;
+        items[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    };
+
+    /**
+     * @brief Consumer only. Returns false when there is nothing to pop.
+     */
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        item = items[t];
+        tail.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    };
+
+    /**
+     * @brief Consumer only. Looks at the next item without removing it.
+     */
+    const T* peek() const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return nullptr;
+        return &items[t];
+    };
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); };
+    uint32_t size() const { return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire)) & (N - 1); };
+    static uint32_t capacity() { return N - 1; };
+
+protected:
+    std::atomic<uint32_t> head;
+    uint8_t headPad[SPSC_QUEUE_PAD - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> tail;
+    uint8_t tailPad[SPSC_QUEUE_PAD - sizeof(std::atomic<uint32_t>)];
+    T items[N];
+};
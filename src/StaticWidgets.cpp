@@ -0,0 +1,67 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "StaticWidgets.h"
+#include "GlyphCache.h"
+
+lv_color_t WidgetColor::resolve() const {
+    switch (kind) {
+        case HEX:               return lv_color_hex(hex);
+        case PALETTE_MAIN:      return lv_palette_main(palette);
+        case PALETTE_LIGHTEN:   return lv_palette_lighten(palette, level);
+        case PALETTE_DARKEN:    return lv_palette_darken(palette, level);
+        default:                return lv_color_black();
+    }
+}
+
+// Same order the setters were called in by hand: size before alignment, range before the value label
+// before the value (so the label shows the initial value), adjacent text last.
+void WidgetDef::applyTo(lvppBase& widget) const {
+    if (geometry.w || geometry.h)
+        widget.setSize(geometry.w, geometry.h);
+    if (geometry.aligned)
+        widget.align(geometry.align, geometry.x, geometry.y);
+    if (fontSize)
+        widget.setFontSize(fontSize);
+    if (colors.bg.isSet())
+        widget.setBGColor(colors.bg.resolve());
+    if (range.hasRange)
+        widget.setRange(range.min, range.max);
+    if (valueLabel.format)
+        widget.setValueLabelFormat(valueLabel.format);
+    if (valueLabel.enabled) {
+        widget.enableValueLabel(valueLabel.x, valueLabel.y, valueLabel.align);
+        // Value labels redraw the same few digits all day - serve them from the glyph cache.
+        widget.setValueLabelFont(GlyphCache::wrap(LV_FONT_DEFAULT));
+    }
+    if (range.hasValue)
+        widget.setValue(range.value);
+    if (colors.gradFrom.isSet())
+        widget.setColorGradient(colors.gradFrom.resolve(), colors.gradTo.resolve(), colors.gradDir);
+    if (adjacent.text)
+        widget.setAdjText(adjacent.text, adjacent.x, adjacent.y);
+}
@@ -0,0 +1,234 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include "WidgetHandle.h"
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A color a WidgetDef can hold at compile time - lv_palette_*() and lv_color_hex() aren't constexpr,
+ *        so the palette, lighten/darken level or hex value is kept and turned into an lv_color_t at init.
+ */
+struct WidgetColor {
+    enum Kind : uint8_t { NONE, HEX, PALETTE_MAIN, PALETTE_LIGHTEN, PALETTE_DARKEN };
+
+    Kind kind;
+    lv_palette_t palette;
+    uint8_t level;
+    uint32_t hex;
+
+    constexpr WidgetColor() : kind(NONE), palette(LV_PALETTE_RED), level(0), hex(0) {};
+    constexpr WidgetColor(Kind _kind, lv_palette_t _palette, uint8_t _level, uint32_t _hex)
+        : kind(_kind), palette(_palette), level(_level), hex(_hex) {};
+
+    /**
+     * @brief level > 0 lightens, level < 0 darkens, 0 is the palette's main color.
+     */
+    static constexpr WidgetColor fromPalette(lv_palette_t p, int8_t level = 0) {
+        return WidgetColor(level > 0 ? PALETTE_LIGHTEN : (level < 0 ? PALETTE_DARKEN : PALETTE_MAIN),
+                           p, (uint8_t) (level < 0 ? -level : level), 0);
+    };
+    static constexpr WidgetColor fromHex(uint32_t hex) { return WidgetColor(HEX, LV_PALETTE_RED, 0, hex); };
+
+    bool isSet() const { return kind != NONE; };
+    lv_color_t resolve() const;
+};
+
+/**
+ * @brief The compile-time description of one widget: geometry, font, colors, range, value label and
+ *        adjacent text. Built with chained constexpr calls, so a definition is pure read-only data -
+ *        no code runs and nothing is allocated until StaticWidget::init() applies it.
+ * @code
+ *     constexpr WidgetDef plus5Def = WidgetDef("+5Min", "  Add\n+1 Min").size(70, 55)
+ *         .at(LV_ALIGN_TOP_MID, 0, 7).font(20).bg(WidgetColor::fromPalette(LV_PALETTE_GREEN, 1));
+ * @endcode
+ *         Anything else (options, callbacks, caches) stays in the init routine next to the init() call.
+ */
+struct WidgetDef {
+    struct Geometry {
+        bool aligned;
+        lv_align_t align;
+        lv_coord_t x, y;
+        lv_coord_t w, h;        // 0 = keep the widget's own size
+    };
+    struct Colors {
+        WidgetColor bg;
+        WidgetColor gradFrom, gradTo;
+        lv_grad_dir_t gradDir;
+    };
+    struct Range {
+        bool hasRange, hasValue;
+        int16_t min, max, value;
+    };
+    struct ValueLabel {
+        const char* format;
+        bool enabled;
+        lv_coord_t x, y;
+        lv_align_t align;
+    };
+    struct Adjacent {
+        const char* text;
+        lv_coord_t x, y;
+    };
+
+    const char* name;
+    const char* text;
+    Geometry geometry;
+    uint8_t fontSize;           // 0 = default font
+    Colors colors;
+    Range range;
+    ValueLabel valueLabel;
+    Adjacent adjacent;
+
+    constexpr WidgetDef(const char* _name, const char* _text = nullptr)
+        : WidgetDef(_name, _text, Geometry{false, LV_ALIGN_DEFAULT, 0, 0, 0, 0}, 0,
+                    Colors{WidgetColor(), WidgetColor(), WidgetColor(), LV_GRAD_DIR_NONE},
+                    Range{false, false, 0, 0, 0}, ValueLabel{nullptr, false, 0, 0, LV_ALIGN_CENTER},
+                    Adjacent{nullptr, 0, 0}) {};
+
+    constexpr WidgetDef at(lv_align_t align, lv_coord_t x = 0, lv_coord_t y = 0) const {
+        return WidgetDef(name, text, Geometry{true, align, x, y, geometry.w, geometry.h}, fontSize, colors, range,
+                         valueLabel, adjacent);
+    };
+    constexpr WidgetDef size(lv_coord_t w, lv_coord_t h) const {
+        return WidgetDef(name, text, Geometry{geometry.aligned, geometry.align, geometry.x, geometry.y, w, h},
+                         fontSize, colors, range, valueLabel, adjacent);
+    };
+    constexpr WidgetDef font(uint8_t size) const {
+        return WidgetDef(name, text, geometry, size, colors, range, valueLabel, adjacent);
+    };
+    constexpr WidgetDef bg(WidgetColor color) const {
+        return WidgetDef(name, text, geometry, fontSize, Colors{color, colors.gradFrom, colors.gradTo, colors.gradDir},
+                         range, valueLabel, adjacent);
+    };
+    constexpr WidgetDef gradient(WidgetColor from, WidgetColor to, lv_grad_dir_t dir) const {
+        return WidgetDef(name, text, geometry, fontSize, Colors{colors.bg, from, to, dir}, range, valueLabel, adjacent);
+    };
+    constexpr WidgetDef limits(int16_t min, int16_t max) const {
+        return WidgetDef(name, text, geometry, fontSize, colors, Range{true, range.hasValue, min, max, range.value},
+                         valueLabel, adjacent);
+    };
+    constexpr WidgetDef value(int16_t v) const {
+        return WidgetDef(name, text, geometry, fontSize, colors, Range{range.hasRange, true, range.min, range.max, v},
+                         valueLabel, adjacent);
+    };
+    constexpr WidgetDef valueText(const char* format, lv_coord_t x, lv_coord_t y, lv_align_t align = LV_ALIGN_CENTER) const {
+        return WidgetDef(name, text, geometry, fontSize, colors, range, ValueLabel{format, true, x, y, align}, adjacent);
+    };
+    constexpr WidgetDef adjText(const char* adj, lv_coord_t x = 0, lv_coord_t y = 0) const {
+        return WidgetDef(name, text, geometry, fontSize, colors, range, valueLabel, Adjacent{adj, x, y});
+    };
+
+    /**
+     * @brief Applies everything but name and text (those go to the constructor).
+     */
+    void applyTo(lvppBase& widget) const;
+
+private:
+    constexpr WidgetDef(const char* _name, const char* _text, Geometry _geometry, uint8_t _fontSize, Colors _colors,
+                        Range _range, ValueLabel _valueLabel, Adjacent _adjacent)
+        : name(_name), text(_text), geometry(_geometry), fontSize(_fontSize), colors(_colors), range(_range),
+          valueLabel(_valueLabel), adjacent(_adjacent) {};
+};
+
+/**
+ * @brief Statically allocated, explicitly constructed storage for one object.
+ * @details Unlike a function-local static there is no guard variable and no destructor registered at
+ *          exit, and unlike new there is no heap block: the object lives in .bss and is built in place
+ *          by the init routine, exactly once. It is never destroyed.
+ */
+template <class T>
+class StaticSlot {
+public:
+    template <class... Args>
+    T& construct(Args&&... args) {
+        return *new (&storage) T(std::forward<Args>(args)...);
+    };
+
+    T* get() { return reinterpret_cast<T*>(&storage); };
+    T* operator->() { return get(); };
+    T& operator*() { return *get(); };
+
+protected:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+};
+
+/**
+ * @brief A StaticSlot for an lvpp widget, constructed from (and configured by) a WidgetDef.
+ */
+template <class T>
+class StaticWidget : public StaticSlot<T> {
+public:
+    /**
+     * @brief Constructs the widget with the definition's name (and text, if the widget takes one),
+     *        registers it for WidgetHandles, applies the definition and adds the widget to screen.
+     */
+    T& init(const WidgetDef& def, lvppScreen* screen) {
+        return finish(place<T>(def), def, screen);
+    };
+
+    /**
+     * @brief As above, for widgets whose constructor takes more than name and text: T(def.name, args...).
+     */
+    template <class A0, class... Args>
+    T& init(const WidgetDef& def, lvppScreen* screen, A0&& arg0, Args&&... args) {
+        return finish(this->construct(def.name, std::forward<A0>(arg0), std::forward<Args>(args)...), def, screen);
+    };
+
+protected:
+    T& finish(T& widget, const WidgetDef& def, lvppScreen* screen) {
+        WidgetHandle<T>::of(&widget);
+        def.applyTo(widget);
+        if (screen)
+            screen->addObject(&widget);
+        return widget;
+    };
+
+    template <class U>
+    typename std::enable_if<std::is_constructible<U, const char*, const char*>::value, U&>::type
+    place(const WidgetDef& def) {
+        return this->construct(def.name, def.text);
+    };
+
+    template <class U>
+    typename std::enable_if<!std::is_constructible<U, const char*, const char*>::value &&
+                            std::is_constructible<U, const char*>::value, U&>::type
+    place(const WidgetDef& def) {
+        return this->construct(def.name);
+    };
+
+    // Custom widgets which name themselves
+    template <class U>
+    typename std::enable_if<!std::is_constructible<U, const char*>::value, U&>::type
+    place(const WidgetDef&) {
+        return this->construct();
+    };
+};
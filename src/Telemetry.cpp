@@ -0,0 +1,221 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "Telemetry.h"
+#include <cstdio>
+#include <cstring>
+#ifdef ESP_PLATFORM
+#include <Arduino.h>
+#else
+#include <thread>
+#endif
+
+// Snapshot attempts before a reader starts backing off.
+#define TELEMETRY_SPIN_LIMIT 64
+
+Telemetry::Value Telemetry::values[TELEMETRY_MAX_VALUES];
+const char* Telemetry::names[TELEMETRY_MAX_VALUES];
+TelemetryType Telemetry::types[TELEMETRY_MAX_VALUES];
+std::atomic<uint8_t> Telemetry::used(0);
+
+std::atomic<uint32_t> Telemetry::version(0);
+std::atomic<uint32_t> Telemetry::inFlight(0);
+std::atomic<uint32_t> Telemetry::reads(0);
+std::atomic<uint32_t> Telemetry::retries(0);
+
+static uint32_t floatBits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+float TelemetrySnapshot::getFloat(TelemetryKey key) const {
+    return bitsFloat(bits[key]);
+}
+
+////////////////////////////////////////
+//
+//  R e g i s t r a t i o n
+//
+////////////////////////////////////////
+
+TelemetryKey Telemetry::add(const char* name, TelemetryType type, uint32_t bits) {
+    TelemetryKey key = find(name);
+    if (key != TELEMETRY_NONE)
+        return key;
+
+    key = used.load(std::memory_order_relaxed);
+    if (key >= TELEMETRY_MAX_VALUES) {
+        printf("Telemetry: no room for '%s' - raise TELEMETRY_MAX_VALUES.\n", name);
+        return TELEMETRY_NONE;
+    }
+
+    names[key] = name;
+    types[key] = type;
+    values[key].bits.store(bits, std::memory_order_relaxed);
+    values[key].version.store(0, std::memory_order_relaxed);
+    // Published last, so a reader counting to 'used' only sees complete entries.
+    used.store(key + 1, std::memory_order_release);
+    return key;
+}
+
+TelemetryKey Telemetry::addValue(const char* name, int32_t initial) {
+    return add(name, TelemetryType::Int, (uint32_t) initial);
+}
+
+TelemetryKey Telemetry::addValue(const char* name, float initial) {
+    return add(name, TelemetryType::Float, floatBits(initial));
+}
+
+TelemetryKey Telemetry::find(const char* name) {
+    uint8_t count = used.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; i++)
+        if (!strcmp(names[i], name))
+            return i;
+    return TELEMETRY_NONE;
+}
+
+////////////////////////////////////////
+//
+//  W r i t e r s
+//
+////////////////////////////////////////
+
+uint32_t Telemetry::beginWrite() {
+    inFlight.fetch_add(1, std::memory_order_seq_cst);
+    return version.fetch_add(1, std::memory_order_seq_cst) + 1;
+}
+
+void Telemetry::endWrite() {
+    inFlight.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void Telemetry::setInt(TelemetryKey key, int32_t value) {
+    uint32_t stamp = beginWrite();
+    values[key].bits.store((uint32_t) value, std::memory_order_seq_cst);
+    values[key].version.store(stamp, std::memory_order_seq_cst);
+    endWrite();
+}
+
+void Telemetry::setFloat(TelemetryKey key, float value) {
+    uint32_t stamp = beginWrite();
+    values[key].bits.store(floatBits(value), std::memory_order_seq_cst);
+    values[key].version.store(stamp, std::memory_order_seq_cst);
+    endWrite();
+}
+
+float Telemetry::getFloat(TelemetryKey key) {
+    return bitsFloat(values[key].bits.load(std::memory_order_acquire));
+}
+
+int32_t Telemetry::addInt(TelemetryKey key, int32_t delta, int32_t low, int32_t high) {
+    uint32_t stamp = beginWrite();
+    uint32_t old = values[key].bits.load(std::memory_order_relaxed);
+    int32_t next;
+    do {
+        int64_t sum = (int64_t)(int32_t) old + delta;
+        next = (int32_t)(sum < low ? low : (sum > high ? high : sum));
+    } while (!values[key].bits.compare_exchange_weak(old, (uint32_t) next, std::memory_order_seq_cst));
+    values[key].version.store(stamp, std::memory_order_seq_cst);
+    endWrite();
+    return next;
+}
+
+Telemetry::Batch::Batch() {
+    stamp = Telemetry::beginWrite();
+}
+
+Telemetry::Batch::~Batch() {
+    Telemetry::endWrite();
+}
+
+void Telemetry::Batch::setFloat(TelemetryKey key, float value) {
+    store(key, floatBits(value));
+}
+
+void Telemetry::Batch::store(TelemetryKey key, uint32_t bits) {
+    values[key].bits.store(bits, std::memory_order_seq_cst);
+    values[key].version.store(stamp, std::memory_order_seq_cst);
+}
+
+////////////////////////////////////////
+//
+//  R e a d e r s
+//
+////////////////////////////////////////
+
+bool Telemetry::read(TelemetrySnapshot& snapshot, uint32_t sinceVersion) {
+    reads.fetch_add(1, std::memory_order_relaxed);
+    uint8_t count = used.load(std::memory_order_acquire);
+
+    for (uint32_t attempt = 0; ; attempt++) {
+        if (attempt) {
+            retries.fetch_add(1, std::memory_order_relaxed);
+            if (attempt >= TELEMETRY_SPIN_LIMIT) {
+                // The writer may be a lower priority task preempted on this core - let it finish.
+#ifdef ESP_PLATFORM
+                vTaskDelay(1);
+#else
+                std::this_thread::yield();
+#endif
+            }
+        }
+
+        if (inFlight.load(std::memory_order_seq_cst))
+            continue;
+        uint32_t start = version.load(std::memory_order_seq_cst);
+
+        uint32_t changed = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            snapshot.bits[i] = values[i].bits.load(std::memory_order_seq_cst);
+            // Wrap-safe "newer than": at 10 kHz the version wraps after about five days.
+            if ((int32_t)(values[i].version.load(std::memory_order_seq_cst) - sinceVersion) > 0)
+                changed |= 1u << i;
+        }
+
+        if (inFlight.load(std::memory_order_seq_cst) || version.load(std::memory_order_seq_cst) != start)
+            continue;
+
+        snapshot.version = start;
+        snapshot.changed = changed;
+        return changed != 0;
+    }
+}
+
+Telemetry::Stats Telemetry::getStats() {
+    Stats s;
+    s.writes = version.load(std::memory_order_relaxed);
+    s.reads = reads.load(std::memory_order_relaxed);
+    s.retries = retries.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,142 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Values the store can hold. One bit each in TelemetrySnapshot::changed.
+#ifndef TELEMETRY_MAX_VALUES
+#define TELEMETRY_MAX_VALUES 32
+#endif
+
+typedef uint8_t TelemetryKey;
+#define TELEMETRY_NONE 0xFF
+
+enum class TelemetryType : uint8_t { Int, Float };
+
+/**
+ * @brief A consistent copy of every value, as of one store version.
+ */
+struct TelemetrySnapshot {
+    uint32_t version;
+    uint32_t changed;       // bit per key: written after the version passed to Telemetry::read()
+    uint32_t bits[TELEMETRY_MAX_VALUES];
+
+    bool hasChanged(TelemetryKey key) const { return key < TELEMETRY_MAX_VALUES && (changed >> key) & 1; };
+    int32_t getInt(TelemetryKey key) const { return (int32_t) bits[key]; };
+    float getFloat(TelemetryKey key) const;
+};
+
+/**
+ * @brief Named, typed values shared by the UI, control and logging tasks without locks.
+ * @details Values are registered once (addValue, from one thread - readers may already be running) and
+ *          then addressed by key. Each value is one 32-bit atomic, so a single get() is always whole. Each
+ *          write stamps the value with the new store version.
+ *
+ *          Writers never block. A write counts itself in flight, takes the next version, stores its value(s)
+ *          and leaves. Readers wanting several values at once call read(). It retries until no write was in
+ *          flight and the version didn't move while it copied, so the snapshot is consistent: either all
+ *          of a Batch's values or none. Under a steady flood of writes a reader backs off (yield, or one
+ *          tick on the ESP32) so a preempted writer on the same core can finish.
+ *
+ *          Subscribers keep the version of their last snapshot and pass it to the next read().
+ *          TelemetrySnapshot::changed then has a bit set for every value written since.
+ */
+class Telemetry {
+public:
+    static TelemetryKey addValue(const char* name, int32_t initial);
+    static TelemetryKey addValue(const char* name, float initial);
+    /**
+     * @return The key, or TELEMETRY_NONE.
+     */
+    static TelemetryKey find(const char* name);
+    static uint8_t count() { return used.load(std::memory_order_acquire); };
+    static const char* getName(TelemetryKey key) { return key < count() ? names[key] : nullptr; };
+    static TelemetryType getType(TelemetryKey key) { return types[key]; };
+
+    static int32_t getInt(TelemetryKey key) { return (int32_t) values[key].bits.load(std::memory_order_acquire); };
+    static float getFloat(TelemetryKey key);
+    static uint32_t getVersion() { return version.load(std::memory_order_acquire); };
+
+    static void setInt(TelemetryKey key, int32_t value);
+    static void setFloat(TelemetryKey key, float value);
+    /**
+     * @brief Atomically adds delta, keeping the result within [low, high]. Returns the new value.
+     */
+    static int32_t addInt(TelemetryKey key, int32_t delta, int32_t low = INT32_MIN, int32_t high = INT32_MAX);
+
+    /**
+     * @brief Consistent snapshot of all values. changed is relative to sinceVersion.
+     * @return true if anything was written after sinceVersion.
+     */
+    static bool read(TelemetrySnapshot& snapshot, uint32_t sinceVersion = 0);
+
+    /**
+     * @brief Several writes which readers see all together or not at all. Keep it short - readers wait it out.
+     */
+    class Batch {
+    public:
+        Batch();
+        ~Batch();
+        void setInt(TelemetryKey key, int32_t value) { store(key, (uint32_t) value); };
+        void setFloat(TelemetryKey key, float value);
+    protected:
+        void store(TelemetryKey key, uint32_t bits);
+        uint32_t stamp;
+    };
+
+    struct Stats {
+        uint32_t writes;    // single writes and batches - the same as the version
+        uint32_t reads;
+        uint32_t retries;   // snapshot attempts a write got in the way of
+    };
+    static Stats getStats();
+
+protected:
+    struct Value {
+        std::atomic<uint32_t> bits;
+        std::atomic<uint32_t> version;
+    };
+
+    static TelemetryKey add(const char* name, TelemetryType type, uint32_t bits);
+    static uint32_t beginWrite();
+    static void endWrite();
+
+    static Value values[TELEMETRY_MAX_VALUES];
+    static const char* names[TELEMETRY_MAX_VALUES];
+    static TelemetryType types[TELEMETRY_MAX_VALUES];
+    // Entries below 'used' are complete. add() publishes with a release store, so readers on other threads
+    // may run while values are still being registered (from one thread at a time).
+    static std::atomic<uint8_t> used;
+
+    static std::atomic<uint32_t> version;
+    static std::atomic<uint32_t> inFlight;
+    static std::atomic<uint32_t> reads;
+    static std::atomic<uint32_t> retries;
+};
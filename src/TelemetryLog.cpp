@@ -0,0 +1,567 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "TelemetryLog.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <chrono>
+#include <sys/mman.h>
+#endif
+
+static_assert(sizeof(TelemetryRecord) == 16, "TelemetryRecord must stay 16 bytes - it is the file format");
+static_assert(sizeof(TelemetryLog::BlockHeader) == 16, "BlockHeader must stay 16 bytes - it is the file format");
+static_assert(TELEMETRY_LOG_INDEX_EVERY * sizeof(TelemetryLog::IndexEntry) + sizeof(TelemetryLog::BlockHeader) <= TELEMETRY_LOG_BLOCK_SIZE,
+              "TELEMETRY_LOG_INDEX_EVERY entries don't fit an index block");
+
+std::atomic<TelemetryLog*> TelemetryLog::instance(nullptr);
+std::atomic<uint32_t> TelemetryLog::producers(0);
+std::atomic<uint32_t> TelemetryLog::queued(0);
+std::atomic<uint32_t> TelemetryLog::dropped(0);
+TelemetryLogStats TelemetryLog::stats;
+
+////////////////////////////////////////
+//
+//  Block format
+//
+////////////////////////////////////////
+
+// CRC-32 (IEEE, as zlib), table driven. The table is built by the first TelemetryLog or reader opened.
+static uint32_t crcTable[256];
+
+static void crcInit() {
+    if (crcTable[1])
+        return;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int bit = 0; bit < 8; bit++)
+            c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crcTable[i] = c;
+    }
+}
+
+static uint32_t crcUpdate(uint32_t c, const uint8_t* p, size_t length) {
+    while (length--)
+        c = crcTable[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c;
+}
+
+static uint32_t payloadBytes(uint32_t magic, uint16_t count) {
+    return count * (magic == TelemetryLog::DATA_MAGIC ? sizeof(TelemetryRecord) : sizeof(TelemetryLog::IndexEntry));
+}
+
+static void sealBlock(uint8_t* block, uint32_t magic, uint32_t number, uint16_t count) {
+    TelemetryLog::BlockHeader* header = (TelemetryLog::BlockHeader*) block;
+    header->magic = magic;
+    header->block = number;
+    header->count = count;
+    header->reserved = 0;
+    header->crc = 0;
+    header->crc = crcUpdate(0xFFFFFFFFu, block, sizeof(TelemetryLog::BlockHeader) + payloadBytes(magic, count)) ^ 0xFFFFFFFFu;
+}
+
+// The block's header if it is block number, of the given kind, within available bytes and its CRC matches.
+static const TelemetryLog::BlockHeader* checkBlock(const uint8_t* block, size_t available, uint32_t number, uint32_t magic) {
+    const TelemetryLog::BlockHeader* header = (const TelemetryLog::BlockHeader*) block;
+    uint16_t maxCount = magic == TelemetryLog::DATA_MAGIC ? TelemetryLog::RECORDS_PER_BLOCK : TELEMETRY_LOG_INDEX_EVERY;
+    if (available < sizeof(TelemetryLog::BlockHeader) || header->magic != magic || header->block != number || header->count > maxCount)
+        return nullptr;
+    uint32_t bytes = sizeof(TelemetryLog::BlockHeader) + payloadBytes(magic, header->count);
+    if (bytes > available)
+        return nullptr;
+
+    // The CRC was taken with the crc field zero.
+    TelemetryLog::BlockHeader copy = *header;
+    copy.crc = 0;
+    uint32_t c = crcUpdate(0xFFFFFFFFu, (const uint8_t*) &copy, sizeof(copy));
+    c = crcUpdate(c, block + sizeof(copy), bytes - sizeof(copy));
+    return (c ^ 0xFFFFFFFFu) == header->crc ? header : nullptr;
+}
+
+static TelemetryLog::IndexEntry recordRange(const TelemetryLog::BlockHeader* header) {
+    TelemetryLog::IndexEntry range = { UINT64_MAX, 0 };
+    if (!header)
+        return range;
+    const TelemetryRecord* records = (const TelemetryRecord*) (header + 1);
+    for (uint16_t i = 0; i < header->count; i++) {
+        if (records[i].timeUS < range.minUS)
+            range.minUS = records[i].timeUS;
+        if (records[i].timeUS > range.maxUS)
+            range.maxUS = records[i].timeUS;
+    }
+    return range;
+}
+
+float TelemetryRecord::getFloat() const {
+    float f;
+    memcpy(&f, &value, sizeof(f));
+    return f;
+}
+
+////////////////////////////////////////
+//
+//  TelemetryLog - producers
+//
+////////////////////////////////////////
+
+TelemetryLog* TelemetryLog::open(const char* path) {
+    if (instance.load())
+        return nullptr;
+    // An existing log already at the limit is rotated before anything is added.
+    struct stat st;
+    if (stat(path, &st) == 0 && (uint64_t) st.st_size >= (uint64_t) maxBlocks() * TELEMETRY_LOG_BLOCK_SIZE) {
+        std::string old = std::string(path) + ".1";
+        if (!rename(path, old.c_str()))
+            stats.rotations++;
+    }
+    int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        printf("TelemetryLog: can't open %s\n", path);
+        return nullptr;
+    }
+    // Appending: a part-filled last block is left as it is and the log carries on in the next one.
+    off_t size = lseek(fd, 0, SEEK_END);
+    uint32_t nextBlock = size > 0 ? (uint32_t) ((size + TELEMETRY_LOG_BLOCK_SIZE - 1) / TELEMETRY_LOG_BLOCK_SIZE) : 0;
+
+    crcInit();
+    TelemetryLog* log = new TelemetryLog(path, fd, nextBlock);
+    log->Start();
+    instance.store(log);
+    return log;
+}
+
+void TelemetryLog::close() {
+    TelemetryLog* log = instance.exchange(nullptr);
+    if (!log)
+        return;
+    // A log call that loaded the pointer before it was cleared finishes its push first.
+    while (producers.load())
+        log->sleepMS(1);
+
+    // The writer task writes out the rest itself, so its state never changes threads.
+    log->closing.store(true, std::memory_order_release);
+    while (!log->closed.load(std::memory_order_acquire))
+        log->sleepMS(TELEMETRY_LOG_PERIOD_MS);
+    log->Terminate();
+    delete log;
+}
+
+uint64_t TelemetryLog::nowUS() {
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+}
+
+bool TelemetryLog::append(const TelemetryRecord& record) {
+    if (!queue.push(record)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    queued.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief The open log for one log call, or nullptr. close() waits for the scope to end before deleting it.
+ */
+class TelemetryLog::ProducerScope {
+public:
+    ProducerScope() {
+        producers.fetch_add(1);
+        log = instance.load();
+    };
+    ~ProducerScope() { producers.fetch_sub(1); };
+
+    TelemetryLog* log;
+};
+
+bool TelemetryLog::logInt(TelemetryKey key, int32_t value, uint64_t timeUS) {
+    ProducerScope scope;
+    if (!scope.log)
+        return false;
+    TelemetryRecord record = { timeUS ? timeUS : nowUS(), TelemetryRecordKind::Int, key, 0, value };
+    return scope.log->append(record);
+}
+
+bool TelemetryLog::logFloat(TelemetryKey key, float value, uint64_t timeUS) {
+    ProducerScope scope;
+    if (!scope.log)
+        return false;
+    TelemetryRecord record = { timeUS ? timeUS : nowUS(), TelemetryRecordKind::Float, key, 0, 0 };
+    memcpy(&record.value, &value, sizeof(value));
+    return scope.log->append(record);
+}
+
+bool TelemetryLog::logEvent(uint8_t code, uint32_t id, uint64_t timeUS) {
+    ProducerScope scope;
+    if (!scope.log)
+        return false;
+    TelemetryRecord record = { timeUS ? timeUS : nowUS(), TelemetryRecordKind::Event, code, 0, (int32_t) id };
+    return scope.log->append(record);
+}
+
+uint8_t TelemetryLog::logChanges(const TelemetrySnapshot& snapshot) {
+    if (!snapshot.changed)
+        return 0;
+    ProducerScope scope;
+    if (!scope.log)
+        return 0;
+    uint64_t now = nowUS();
+    uint8_t logged = 0;
+    for (TelemetryKey key = 0; key < Telemetry::count(); key++) {
+        if (!snapshot.hasChanged(key))
+            continue;
+        TelemetryRecordKind kind = Telemetry::getType(key) == TelemetryType::Float ? TelemetryRecordKind::Float : TelemetryRecordKind::Int;
+        TelemetryRecord record = { now, kind, key, 0, (int32_t) snapshot.bits[key] };
+        if (scope.log->append(record))
+            logged++;
+    }
+    return logged;
+}
+
+TelemetryLogStats TelemetryLog::getStats() {
+    TelemetryLogStats s = stats;
+    s.queued = queued.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    return s;
+}
+
+void TelemetryLog::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+    queued = 0;
+    dropped = 0;
+}
+
+////////////////////////////////////////
+//
+//  TelemetryLog - writer task
+//
+////////////////////////////////////////
+
+TelemetryLog::TelemetryLog(const char* _path, int _fd, uint32_t nextBlock) : RoboTask("TelemetryLog", 1, 4096) {
+    path = _path;
+    fd = _fd;
+    staging = new uint8_t[TELEMETRY_LOG_BATCH_BLOCKS * TELEMETRY_LOG_BLOCK_SIZE];
+    stagedBlocks = 0;
+    firstStaged = nextBlock;
+    fillCount = 0;
+    fillRange = { UINT64_MAX, 0 };
+    groupBlocks = 0;
+    dirty = false;
+    closing = false;
+    closed = false;
+    resume();
+    setBaseRunDelay(TELEMETRY_LOG_PERIOD_MS);
+}
+
+TelemetryLog::~TelemetryLog() {
+    delete[] staging;
+}
+
+// An existing log ends part way through a group - its index block needs the time ranges of the data
+// blocks already there.
+void TelemetryLog::resume() {
+    groupBlocks = firstStaged % GROUP_BLOCKS;
+    uint32_t first = firstStaged - groupBlocks;
+    for (uint16_t i = 0; i < groupBlocks; i++) {
+        ssize_t got = -1;
+        if (lseek(fd, (off_t) (first + i) * TELEMETRY_LOG_BLOCK_SIZE, SEEK_SET) >= 0)
+            got = read(fd, staging, TELEMETRY_LOG_BLOCK_SIZE);
+        group[i] = recordRange(checkBlock(staging, got > 0 ? got : 0, first + i, DATA_MAGIC));
+    }
+    if (groupBlocks == TELEMETRY_LOG_INDEX_EVERY)
+        writeIndex();
+}
+
+void TelemetryLog::Run() {
+    if (closed.load(std::memory_order_relaxed))
+        return;
+    drain();
+    writeStaged();
+
+    if (closing.load(std::memory_order_acquire)) {
+        if (fillCount) {
+            stats.records += fillCount;
+            writePartial();
+        }
+        else
+            fsync(fd);
+        ::close(fd);
+        closed.store(true, std::memory_order_release);
+        return;
+    }
+
+    // Records only wait TELEMETRY_LOG_FLUSH_MS in a part-filled block.
+    if (!dirty)
+        resetElapsedTimer();
+    else if (hasElapsed(TELEMETRY_LOG_FLUSH_MS)) {
+        writePartial();
+        resetElapsedTimer();
+    }
+}
+
+void TelemetryLog::drain() {
+    // Bounded, so a flood of producers can't keep the task (or close()) here forever.
+    TelemetryRecord record;
+    for (uint32_t n = 0; n < 4 * TELEMETRY_LOG_QUEUE_SIZE && queue.pop(record); n++)
+        addRecord(record);
+}
+
+void TelemetryLog::addRecord(const TelemetryRecord& record) {
+    TelemetryRecord* records = (TelemetryRecord*) (currentBlock() + sizeof(BlockHeader));
+    records[fillCount++] = record;
+    if (record.timeUS < fillRange.minUS)
+        fillRange.minUS = record.timeUS;
+    if (record.timeUS > fillRange.maxUS)
+        fillRange.maxUS = record.timeUS;
+    dirty = true;
+
+    if (fillCount == RECORDS_PER_BLOCK)
+        finishBlock();
+}
+
+void TelemetryLog::finishBlock() {
+    sealBlock(currentBlock(), DATA_MAGIC, firstStaged + stagedBlocks, fillCount);
+    group[groupBlocks++] = fillRange;
+    stats.records += fillCount;
+    stats.dataBlocks++;
+    fillCount = 0;
+    fillRange = { UINT64_MAX, 0 };
+    dirty = false;
+    nextBlock();
+
+    if (groupBlocks == TELEMETRY_LOG_INDEX_EVERY)
+        writeIndex();
+}
+
+void TelemetryLog::writeIndex() {
+    uint8_t* block = currentBlock();
+    memset(block, 0, TELEMETRY_LOG_BLOCK_SIZE);
+    memcpy(block + sizeof(BlockHeader), group, groupBlocks * sizeof(IndexEntry));
+    sealBlock(block, INDEX_MAGIC, firstStaged + stagedBlocks, groupBlocks);
+    groupBlocks = 0;
+    stats.indexBlocks++;
+    nextBlock();
+
+    // A group is complete and nothing is waiting in a part-filled block - the place to start a new file.
+    if (firstStaged + stagedBlocks >= maxBlocks()) {
+        writeStaged();
+        rotate();
+    }
+}
+
+uint32_t TelemetryLog::maxBlocks() {
+    uint32_t groups = (uint32_t) ((uint64_t) TELEMETRY_LOG_MAX_BYTES / TELEMETRY_LOG_BLOCK_SIZE / GROUP_BLOCKS);
+    return (groups ? groups : 1) * GROUP_BLOCKS;
+}
+
+bool TelemetryLog::rotate() {
+    fsync(fd);
+    std::string old = path + ".1";
+    if (rename(path.c_str(), old.c_str())) {
+        // Can't rename - carry on in the same file rather than lose records.
+        if (!stats.errors++)
+            printf("TelemetryLog: can't rotate %s\n", path.c_str());
+        return false;
+    }
+    int newFD = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (newFD < 0) {
+        // The renamed file is still open - keep appending to it.
+        stats.errors++;
+        return false;
+    }
+    ::close(fd);
+    fd = newFD;
+    firstStaged = 0;
+    stats.rotations++;
+    return true;
+}
+
+void TelemetryLog::nextBlock() {
+    if (++stagedBlocks == TELEMETRY_LOG_BATCH_BLOCKS)
+        writeStaged();
+}
+
+void TelemetryLog::writeStaged() {
+    if (!stagedBlocks)
+        return;
+    writeAt(firstStaged, staging, stagedBlocks * TELEMETRY_LOG_BLOCK_SIZE);
+    firstStaged += stagedBlocks;
+    // The block being filled moves to the front.
+    if (fillCount)
+        memmove(staging, currentBlock(), sizeof(BlockHeader) + fillCount * sizeof(TelemetryRecord));
+    stagedBlocks = 0;
+}
+
+void TelemetryLog::writePartial() {
+    // Only the part in use - the block is written again, whole, once it fills up.
+    sealBlock(staging, DATA_MAGIC, firstStaged, fillCount);
+    writeAt(firstStaged, staging, sizeof(BlockHeader) + fillCount * sizeof(TelemetryRecord));
+    fsync(fd);
+    stats.partialFlushes++;
+    dirty = false;
+}
+
+bool TelemetryLog::writeAt(uint32_t block, const uint8_t* data, uint32_t bytes) {
+    stats.writes++;
+    if (lseek(fd, (off_t) block * TELEMETRY_LOG_BLOCK_SIZE, SEEK_SET) < 0) {
+        stats.errors++;
+        return false;
+    }
+    while (bytes) {
+        ssize_t done = write(fd, data, bytes);
+        if (done <= 0) {
+            if (!stats.errors++)
+                printf("TelemetryLog: write failed at block %u\n", (unsigned) block);
+            return false;
+        }
+        data += done;
+        bytes -= done;
+        stats.bytesWritten += done;
+    }
+    return true;
+}
+
+////////////////////////////////////////
+//
+//  TelemetryLogReader
+//
+////////////////////////////////////////
+
+TelemetryLogReader::TelemetryLogReader() : data(nullptr), size(0), blocks(0), tailFirst(0), blocksRead(0), badBlocks(0) {
+    crcInit();
+}
+
+TelemetryLogReader::~TelemetryLogReader() {
+    close();
+}
+
+bool TelemetryLogReader::open(const char* path) {
+#ifdef ESP_PLATFORM
+    (void) path;
+    return false;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    close();
+    data = (const uint8_t*) map;
+    size = st.st_size;
+    blocks = (uint32_t) ((size + TELEMETRY_LOG_BLOCK_SIZE - 1) / TELEMETRY_LOG_BLOCK_SIZE);
+
+    tailFirst = blocks - blocks % TelemetryLog::GROUP_BLOCKS;
+    for (uint32_t b = tailFirst; b < blocks; b++)
+        tail.push_back(recordRange(block(b, TelemetryLog::DATA_MAGIC)));
+    return true;
+#endif
+}
+
+void TelemetryLogReader::close() {
+#ifndef ESP_PLATFORM
+    if (data)
+        munmap((void*) data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    blocks = 0;
+    tailFirst = 0;
+    tail.clear();
+}
+
+const TelemetryLog::BlockHeader* TelemetryLogReader::block(uint32_t number, uint32_t magic) {
+    size_t offset = (size_t) number * TELEMETRY_LOG_BLOCK_SIZE;
+    size_t available = size - offset < TELEMETRY_LOG_BLOCK_SIZE ? size - offset : TELEMETRY_LOG_BLOCK_SIZE;
+    blocksRead++;
+    const TelemetryLog::BlockHeader* header = checkBlock(data + offset, available, number, magic);
+    if (!header)
+        badBlocks++;
+    return header;
+}
+
+uint32_t TelemetryLogReader::visitBlock(const TelemetryLog::BlockHeader* header, uint64_t fromUS, uint64_t toUS,
+                                        const std::function<void(const TelemetryRecord&)>& visit) {
+    if (!header)
+        return 0;
+    const TelemetryRecord* records = (const TelemetryRecord*) (header + 1);
+    uint32_t visited = 0;
+    for (uint16_t i = 0; i < header->count; i++) {
+        if (records[i].timeUS >= fromUS && records[i].timeUS <= toUS) {
+            visit(records[i]);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+uint32_t TelemetryLogReader::query(uint64_t fromUS, uint64_t toUS, const std::function<void(const TelemetryRecord&)>& visit) {
+    uint32_t visited = 0;
+    for (uint32_t first = 0; first < blocks; first += TelemetryLog::GROUP_BLOCKS) {
+        uint32_t indexNumber = first + TELEMETRY_LOG_INDEX_EVERY;
+        const TelemetryLog::BlockHeader* index = indexNumber < blocks ? block(indexNumber, TelemetryLog::INDEX_MAGIC) : nullptr;
+
+        const TelemetryLog::IndexEntry* entries = nullptr;
+        uint32_t count = 0;
+        if (index) {
+            entries = (const TelemetryLog::IndexEntry*) (index + 1);
+            count = index->count;
+        }
+        else if (first == tailFirst) {
+            entries = tail.data();
+            count = tail.size();
+        }
+
+        if (entries) {
+            // Only the data blocks whose time range overlaps the query.
+            for (uint32_t i = 0; i < count; i++)
+                if (entries[i].minUS <= toUS && entries[i].maxUS >= fromUS)
+                    visited += visitBlock(block(first + i, TelemetryLog::DATA_MAGIC), fromUS, toUS, visit);
+        }
+        else {
+            // An index block that didn't check out - every data block in the group.
+            for (uint32_t b = first; b < indexNumber; b++)
+                visited += visitBlock(block(b, TelemetryLog::DATA_MAGIC), fromUS, toUS, visit);
+        }
+    }
+    return visited;
+}
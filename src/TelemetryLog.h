@@ -0,0 +1,287 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "robotask.h"
+#include "MpscQueue.h"
+#include "Telemetry.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// File the emulator logs to (relative to where it is run).
+#ifndef TELEMETRY_LOG_PATH
+#define TELEMETRY_LOG_PATH "telemetry.log"
+#endif
+
+// Once the log reaches this size it is renamed to <path>.1, replacing the one before, and a new log is
+// started - at most twice this is kept. Rounded down to whole index groups (at least one).
+#ifndef TELEMETRY_LOG_MAX_BYTES
+#define TELEMETRY_LOG_MAX_BYTES (16 * 1024 * 1024)
+#endif
+
+// Size of one block of the log file - a flash sector on the ESP32, a page on native.
+#ifndef TELEMETRY_LOG_BLOCK_SIZE
+#define TELEMETRY_LOG_BLOCK_SIZE 4096
+#endif
+
+// Data blocks between index blocks.
+#ifndef TELEMETRY_LOG_INDEX_EVERY
+#define TELEMETRY_LOG_INDEX_EVERY 64
+#endif
+
+// Records waiting for the writer task (power of two), and blocks it gathers into one write().
+#ifndef TELEMETRY_LOG_QUEUE_SIZE
+#ifdef ESP_PLATFORM
+#define TELEMETRY_LOG_QUEUE_SIZE 256
+#else
+#define TELEMETRY_LOG_QUEUE_SIZE 8192
+#endif
+#endif
+#ifndef TELEMETRY_LOG_BATCH_BLOCKS
+#ifdef ESP_PLATFORM
+#define TELEMETRY_LOG_BATCH_BLOCKS 2
+#else
+#define TELEMETRY_LOG_BATCH_BLOCKS 16
+#endif
+#endif
+
+// How often the writer task wakes up, and how long records may sit in a part-filled block before
+// it is written out anyway.
+#ifndef TELEMETRY_LOG_PERIOD_MS
+#define TELEMETRY_LOG_PERIOD_MS 20
+#endif
+#ifndef TELEMETRY_LOG_FLUSH_MS
+#define TELEMETRY_LOG_FLUSH_MS 1000
+#endif
+
+enum class TelemetryRecordKind : uint8_t { Int, Float, Event };
+
+/**
+ * @brief One fixed size log entry.
+ */
+struct TelemetryRecord {
+    uint64_t timeUS;            // TelemetryLog::nowUS() when it was logged, unless the caller gave a time
+    TelemetryRecordKind kind;
+    uint8_t key;                // TelemetryKey, or the LVGL event code for an Event
+    uint16_t reserved;
+    int32_t value;              // Int value, Float bits, or the widget ID (widgetID()) for an Event
+
+    float getFloat() const;
+};
+
+struct TelemetryLogStats {
+    uint32_t queued;            // records accepted by append()
+    uint32_t dropped;           // records refused - the writer was TELEMETRY_LOG_QUEUE_SIZE behind
+    uint32_t records;           // records in blocks handed to write()
+    uint32_t dataBlocks;
+    uint32_t indexBlocks;
+    uint32_t writes;            // write() calls
+    uint32_t partialFlushes;    // part-filled blocks written because TELEMETRY_LOG_FLUSH_MS passed
+    uint64_t bytesWritten;
+    uint32_t errors;
+    uint32_t rotations;         // logs renamed to <path>.1 at TELEMETRY_LOG_MAX_BYTES
+
+    /**
+     * @brief Bytes written per byte of records: block headers, index blocks and partial blocks written again.
+     */
+    double writeAmplification() const { return records ? (double) bytesWritten / ((double) records * sizeof(TelemetryRecord)) : 0.0; };
+};
+
+/**
+ * @brief Append-only binary log of telemetry values and UI events, written by its own task.
+ * @details Any thread (or RoboTask) logs by pushing a record into a lock-free multi-producer queue - it
+ *          never waits for I/O and never takes a lock. When the writer falls behind, records are dropped
+ *          and counted rather than blocking anyone.
+ *
+ *          The writer task drains the queue every TELEMETRY_LOG_PERIOD_MS into fixed size blocks and writes
+ *          up to TELEMETRY_LOG_BATCH_BLOCKS finished blocks with one write(). A part-filled block is written
+ *          out after TELEMETRY_LOG_FLUSH_MS, and written again in place as it fills.
+ *
+ *          File layout: blocks of TELEMETRY_LOG_BLOCK_SIZE. Every (TELEMETRY_LOG_INDEX_EVERY + 1)th block is
+ *          an index block holding the time range of each data block before it; all other blocks are data
+ *          blocks of TelemetryRecords. Each block starts with a BlockHeader carrying its block number and a
+ *          CRC-32, so a torn or stale block is detected and skipped. Opening an existing log appends to it.
+ *          At TELEMETRY_LOG_MAX_BYTES, right after an index block, the log is rotated to <path>.1.
+ *
+ *          There is one log per program, like InputSampler. The static log*() calls do nothing (and return
+ *          false) until open() has been called.
+ */
+class TelemetryLog : public RoboTask {
+public:
+    static const uint32_t DATA_MAGIC = 0x474F4C54;     // "TLOG"
+    static const uint32_t INDEX_MAGIC = 0x58444954;    // "TIDX"
+
+    struct BlockHeader {
+        uint32_t magic;
+        uint32_t block;         // this block's number in the file
+        uint16_t count;         // records (data block) or entries (index block)
+        uint16_t reserved;
+        uint32_t crc;           // CRC-32 of the header (with crc = 0) and the count records/entries
+    };
+    struct IndexEntry {
+        uint64_t minUS;         // an unreadable block gets minUS > maxUS, which matches no range
+        uint64_t maxUS;
+    };
+    static const uint32_t RECORDS_PER_BLOCK = (TELEMETRY_LOG_BLOCK_SIZE - sizeof(BlockHeader)) / sizeof(TelemetryRecord);
+    static const uint32_t GROUP_BLOCKS = TELEMETRY_LOG_INDEX_EVERY + 1;
+
+    /**
+     * @brief Opens (or creates) the log file and starts the writer task.
+     * @return The log, or nullptr if the file can't be opened or a log is already open.
+     */
+    static TelemetryLog* open(const char* path);
+    static TelemetryLog* get() { return instance.load(); };
+    /**
+     * @brief Has the writer task write out everything queued (the part-filled block too), close the file
+     *        and stop. Stop logging first - records logged meanwhile may be lost.
+     */
+    static void close();
+
+    /**
+     * @param timeUS 0 stamps the record with nowUS().
+     */
+    static bool logInt(TelemetryKey key, int32_t value, uint64_t timeUS = 0);
+    static bool logFloat(TelemetryKey key, float value, uint64_t timeUS = 0);
+    /**
+     * @param id The widget's WIDGET_ID().
+     */
+    static bool logEvent(uint8_t code, uint32_t id, uint64_t timeUS = 0);
+    /**
+     * @brief Logs every value that changed in the snapshot. Returns how many were logged.
+     */
+    static uint8_t logChanges(const TelemetrySnapshot& snapshot);
+
+    /**
+     * @brief Any thread. Returns false if the record was dropped.
+     */
+    bool append(const TelemetryRecord& record);
+    /**
+     * @brief Microseconds for record timestamps: since the epoch on native, since boot on the ESP32.
+     */
+    static uint64_t nowUS();
+
+    void Run();
+
+    /**
+     * @brief The writer's counts are only exact once close() has returned.
+     */
+    static TelemetryLogStats getStats();
+    static void resetStats();
+
+protected:
+    TelemetryLog(const char* path, int fd, uint32_t nextBlock);
+    ~TelemetryLog();
+
+    void resume();
+    void drain();
+    void addRecord(const TelemetryRecord& record);
+    void finishBlock();
+    void writeIndex();
+    void nextBlock();
+    void writeStaged();
+    void writePartial();
+    bool rotate();
+    bool writeAt(uint32_t block, const uint8_t* data, uint32_t bytes);
+    uint8_t* currentBlock() { return staging + stagedBlocks * TELEMETRY_LOG_BLOCK_SIZE; };
+
+    static uint32_t maxBlocks();
+
+    std::string path;
+    int fd;
+    MpscQueue<TelemetryRecord, TELEMETRY_LOG_QUEUE_SIZE> queue;
+    // Finished blocks waiting to be written, then the block being filled.
+    uint8_t* staging;
+    uint32_t stagedBlocks;
+    // File block number of staging[0].
+    uint32_t firstStaged;
+    uint16_t fillCount;
+    IndexEntry fillRange;
+    // Records added since the block being filled was last written.
+    bool dirty;
+    std::atomic<bool> closing;
+    std::atomic<bool> closed;
+    // Time ranges of the data blocks since the last index block.
+    IndexEntry group[TELEMETRY_LOG_INDEX_EVERY];
+    uint16_t groupBlocks;
+
+    class ProducerScope;
+    // Log calls load instance once and are counted in producers while they use it, so close() can
+    // clear instance and then wait for the calls already under way before deleting the log.
+    static std::atomic<TelemetryLog*> instance;
+    static std::atomic<uint32_t> producers;
+    static std::atomic<uint32_t> queued;
+    static std::atomic<uint32_t> dropped;
+    static TelemetryLogStats stats;
+};
+
+/**
+ * @brief Range queries by time over a log file, memory-mapped (native only).
+ * @details The index blocks let a query skip whole groups of data blocks by reading one block, and only the
+ *          data blocks whose time range overlaps the query are read. The time ranges of the tail of the file
+ *          that no index block covers yet are worked out once, by open(). Every block's CRC is checked
+ *          before it is used.
+ *          The file may still be growing; the map covers what was there when open() was called.
+ */
+class TelemetryLogReader {
+public:
+    TelemetryLogReader();
+    ~TelemetryLogReader();
+
+    bool open(const char* path);
+    void close();
+
+    /**
+     * @brief Calls visit for each record with fromUS <= timeUS <= toUS, in file order.
+     * @return The number of records visited.
+     */
+    uint32_t query(uint64_t fromUS, uint64_t toUS, const std::function<void(const TelemetryRecord&)>& visit);
+
+    uint32_t getBlockCount() const { return blocks; };
+    /**
+     * @brief Data blocks read and blocks found corrupt (bad magic, number or CRC) by queries so far.
+     */
+    uint32_t getBlocksRead() const { return blocksRead; };
+    uint32_t getBadBlocks() const { return badBlocks; };
+
+protected:
+    const TelemetryLog::BlockHeader* block(uint32_t number, uint32_t magic);
+    uint32_t visitBlock(const TelemetryLog::BlockHeader* header, uint64_t fromUS, uint64_t toUS,
+                        const std::function<void(const TelemetryRecord&)>& visit);
+
+    const uint8_t* data;
+    size_t size;
+    uint32_t blocks;
+    // Time range of each data block after the last complete group.
+    uint32_t tailFirst;
+    std::vector<TelemetryLog::IndexEntry> tail;
+    uint32_t blocksRead;
+    uint32_t badBlocks;
+};
@@ -27,14 +27,17 @@
 //
 #include "TheBrain.h"
 #include "Widgets.h"
+#include "TelemetryLog.h"
+#ifndef ESP_PLATFORM
+#include "SensorSim.h"
+#endif
 
 #ifndef ESP_PLATFORM
 int16_t getrand(int16_t low, int16_t high) {
     int totalRange = high-low;
-    float v = rand()/RAND_MAX;  // Gives back 0-1 in float
+    float v = rand() / (float) RAND_MAX;  // Gives back 0-1 in float (rand()/RAND_MAX alone is integer division - always 0)
     int randRange = v*totalRange;   // Now we're normalized to the desired range
     int final = low + randRange;
-    printf("normalized 0-1 is: %f, randRange: %d, and final: %d\n", v, randRange, final);
     return final;
 }
 
@@ -50,15 +53,20 @@ void instantiateCommonItems() {
 }
 
 TheBrain::TheBrain() : LockingRoboTask("TheBrain", 1, 8192) {
-    temperature = 62;
-    secondsRemaining = 60;
-    fullPercentage = 40;
+    temperature = Telemetry::addValue("temperature", (int32_t) 62);
+    secondsRemaining = Telemetry::addValue("secondsRemaining", (int32_t) 60);
+    fullPercentage = Telemetry::addValue("fullPercentage", (int32_t) 40);
+    shownVersion = 0;
 
     assert(pScreenMain);
     assert(pTempGauge);
     assert(pTimeStatus);
+    assert(pTempHistory && pWaterHistory);
+    waterLevel = WidgetHandle<lvppBar>::find(WIDGET_ID("H2OLevel"));
+    assert(waterLevel);
 
-    setBaseRunDelay(200);
+    // Sensors may publish every display frame, so the widgets follow at that rate.
+    setBaseRunDelay(LV_DISP_DEF_REFR_PERIOD);
     this->Start();
 }
 
@@ -68,31 +76,74 @@ TheBrain::~TheBrain() {
 void TheBrain::Run() {
     if (hasElapsed(1000)) {
         resetElapsedTimer();
+        simulate();
+    }
+    recordHistory();
+    refreshUI();
+}
 
-        // Update UI items
-        temperature += 5;
-        if (temperature > 105)
-            temperature = 55;
-        pTempGauge->setTemp(temperature);
+void TheBrain::simulate() {
+    // Counts down whatever feeds the sensor values.
+    Telemetry::addInt(secondsRemaining, -1, 0);
 
-        fullPercentage += 5;
-        if (fullPercentage > 100)
-            fullPercentage = 10;
-        pScreenMain->setObjValue("H2OLevel", fullPercentage);
+#ifndef ESP_PLATFORM
+    // The emulator's sensor simulation publishes temperature and fullPercentage itself.
+    if (SensorSim::running())
+        return;
+#endif
 
-        secondsRemaining--;
-        if (secondsRemaining <= 0) {
-            pTimeStatus->setText("STOPPED");
-            secondsRemaining = 0;
-        }
-        else {
-            std::string rem("Time: " + std::to_string(secondsRemaining));
-            pTimeStatus->setText(rem.c_str());
-        }
+    int32_t temp = Telemetry::getInt(temperature) + 5;
+    if (temp > 105)
+        temp = 55;
+    int32_t full = Telemetry::getInt(fullPercentage) + 5;
+    if (full > 100)
+        full = 10;
+
+    {
+        Telemetry::Batch batch;
+        batch.setInt(temperature, temp);
+        batch.setInt(fullPercentage, full);
     }
+}
 
+void TheBrain::updateUI() {
+    simulate();
+    recordHistory();
+    refreshUI();
+}
+
+void TheBrain::recordHistory() {
+    // A sample every run, changed or not - the charts fold HISTORY_COLUMN_MS of them into each column.
+    pTempHistory->append(Telemetry::getInt(temperature));
+    pWaterHistory->append(Telemetry::getInt(fullPercentage));
+}
+
+void TheBrain::refreshUI() {
+    // Only what changed since the last update is pushed to the widgets.
+    TelemetrySnapshot state;
+    if (!Telemetry::read(state, shownVersion))
+        return;
+    shownVersion = state.version;
+    // Recorded as shown - a no-op unless a TelemetryLog is open.
+    TelemetryLog::logChanges(state);
+
+    if (state.hasChanged(temperature))
+        pTempGauge->setTemp(state.getInt(temperature));
+
+    if (state.hasChanged(fullPercentage))
+        if (lvppBar* bar = waterLevel.get())
+            bar->setValue(state.getInt(fullPercentage));
+
+    // Formatted in place - no heap string, and nothing is redrawn while the text stays the same.
+    if (state.hasChanged(secondsRemaining)) {
+        int32_t seconds = state.getInt(secondsRemaining);
+        if (seconds <= 0)
+            pTimeStatus->setText("STOPPED");
+        else
+            pTimeStatus->format("Time: %d", (int) seconds);
+    }
 }
 
 void TheBrain::AddSeconds(uint16_t secs) {
-    secondsRemaining += secs;
+    Telemetry::addInt(secondsRemaining, secs, 0, INT16_MAX);
 }
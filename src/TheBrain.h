@@ -27,6 +27,8 @@
 //
 #pragma once
 #include "main_header.h"
+#include "WidgetHandle.h"
+#include "Telemetry.h"
 
 #define MAX_SLEEP_TEXT 30
 
@@ -36,11 +38,37 @@ public:
     TheBrain();
     ~TheBrain();
     void Run();
+    /**
+     * @brief Safe from any thread (it is called from the "+1 Min" button's LVGL callback).
+     */
     void AddSeconds(uint16_t secs);
+    /**
+     * @brief One second's simulation step, a history sample and refreshUI(). Run() does the same on its own clock, but a
+     *        driver with the LVGL mutex held (like the headless benchmark) can call it directly.
+     */
+    void updateUI();
+    /**
+     * @brief Brings the widgets up to date with whatever changed in the telemetry since the last call.
+     */
+    void refreshUI();
 
 protected:
-    int16_t  secondsRemaining;
-    int8_t   temperature;
-    uint16_t fullPercentage;
+    /**
+     * @brief Advances the simulated state by one second and publishes it to the telemetry store.
+     *        Temperature and water level are left to a running SensorSim (emulator).
+     */
+    void simulate();
+    /**
+     * @brief Appends the current temperature and water level to their history charts.
+     */
+    void recordHistory();
+
+    // State lives in the Telemetry store, so the UI, control and logging tasks can all read it.
+    TelemetryKey secondsRemaining;
+    TelemetryKey temperature;
+    TelemetryKey fullPercentage;
+    // Store version the widgets currently show.
+    uint32_t shownVersion;
+    WidgetHandle<lvppBar> waterLevel;
 
 };
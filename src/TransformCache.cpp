@@ -0,0 +1,174 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "TransformCache.h"
+
+std::list<TransformedImageCache::Entry> TransformedImageCache::entries;
+TransformCacheStats TransformedImageCache::stats = { 0, 0, 0, 0, 0, 0 };
+uint32_t TransformedImageCache::budget = TRANSFORM_CACHE_BUDGET;
+
+bool TransformedImageCache::Key::operator==(const Key& o) const {
+    return src == o.src && angle == o.angle && zoom == o.zoom && pivot.x == o.pivot.x && pivot.y == o.pivot.y &&
+           w == o.w && h == o.h && cf == o.cf && antialias == o.antialias;
+}
+
+bool TransformedImageCache::makeRoom(uint32_t bytes) {
+    // Walk from the least recently used end, skipping anything still on screen.
+    auto it = entries.end();
+    while (stats.bytesInUse + bytes > budget && it != entries.begin()) {
+        --it;
+        if (it->refs)
+            continue;
+
+        lv_img_cache_invalidate_src(it->img);
+#if LV_USE_SNAPSHOT
+        lv_snapshot_free(it->img);
+#endif
+        stats.bytesInUse -= it->bytes;
+        stats.evictions++;
+        it = entries.erase(it);
+    }
+
+    stats.entries = entries.size();
+    return stats.bytesInUse + bytes <= budget;
+}
+
+TransformedImageCache::Entry* TransformedImageCache::acquire(const Key& key, lv_obj_t* like) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->key == key) {
+            stats.hits++;
+            entries.splice(entries.begin(), entries, it);
+            entries.front().refs++;
+            return &entries.front();
+        }
+    }
+
+#if !LV_USE_SNAPSHOT
+    // Nothing to render the transform with - the image keeps transforming on every redraw.
+    (void) like;
+    stats.rejected++;
+    return nullptr;
+#else
+    // Render the transform with a throw-away lv_img set up exactly like the original. It is deleted
+    // again before any refresh can happen, so it never shows up on screen.
+    lv_obj_t* tmp = lv_img_create(lv_obj_get_parent(like));
+    lv_img_set_src(tmp, key.src);
+    lv_obj_set_size(tmp, key.w, key.h);
+    lv_img_set_pivot(tmp, key.pivot.x, key.pivot.y);
+    lv_img_set_angle(tmp, key.angle);
+    lv_img_set_zoom(tmp, key.zoom);
+    lv_img_set_antialias(tmp, key.antialias);
+    lv_obj_update_layout(tmp);
+
+    Entry e;
+    e.key = key;
+    e.ext = _lv_obj_get_ext_draw_size(tmp);
+    e.bytes = lv_snapshot_buf_size_needed(tmp, key.cf);
+    e.refs = 1;
+    e.img = nullptr;
+
+    if (e.bytes && makeRoom(e.bytes))
+        e.img = lv_snapshot_take(tmp, key.cf);
+    lv_obj_del(tmp);
+
+    if (!e.img) {
+        stats.rejected++;
+        return nullptr;
+    }
+
+    stats.misses++;
+    stats.bytesInUse += e.bytes;
+    entries.push_front(e);
+    stats.entries = entries.size();
+    return &entries.front();
+#endif
+}
+
+void TransformedImageCache::release(lv_img_dsc_t* img) {
+    for (Entry& e : entries) {
+        if (e.img == img) {
+            if (e.refs)
+                e.refs--;
+            return;
+        }
+    }
+}
+
+void TransformedImageCache::objDeleted(lv_event_t* e) {
+    release((lv_img_dsc_t*)lv_event_get_user_data(e));
+}
+
+bool TransformedImageCache::applyTo(lv_obj_t* img) {
+    const int16_t angle = lv_img_get_angle(img);
+    const uint16_t zoom = lv_img_get_zoom(img);
+    if (angle == 0 && zoom == LV_IMG_ZOOM_NONE)
+        return false;
+
+    lv_obj_update_layout(img);
+
+    Key key;
+    key.src = lv_img_get_src(img);
+    key.angle = angle;
+    key.zoom = zoom;
+    lv_img_get_pivot(img, &key.pivot);
+    key.w = lv_obj_get_width(img);
+    key.h = lv_obj_get_height(img);
+    key.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    key.antialias = lv_img_get_antialias(img);
+
+    Entry* e = acquire(key, img);
+    if (!e)
+        return false;
+
+    // The bitmap covers the object's area grown by 'ext' on every side. Grow the object to match
+    // and move it back by 'ext' while keeping whatever alignment it already had.
+    lv_area_t before;
+    lv_area_t after;
+    lv_obj_get_coords(img, &before);
+
+    lv_img_set_angle(img, 0);
+    lv_img_set_zoom(img, LV_IMG_ZOOM_NONE);
+    lv_img_set_src(img, e->img);
+    lv_obj_set_size(img, key.w + 2 * e->ext, key.h + 2 * e->ext);
+    lv_obj_update_layout(img);
+    lv_obj_get_coords(img, &after);
+
+    lv_obj_set_pos(img, lv_obj_get_style_x(img, LV_PART_MAIN) + (before.x1 - e->ext - after.x1),
+                        lv_obj_get_style_y(img, LV_PART_MAIN) + (before.y1 - e->ext - after.y1));
+
+    lv_obj_add_event_cb(img, objDeleted, LV_EVENT_DELETE, e->img);
+    return true;
+}
+
+void TransformedImageCache::setBudget(uint32_t bytes) {
+    budget = bytes;
+    makeRoom(0);
+}
+
+TransformCacheStats TransformedImageCache::getStats() {
+    return stats;
+}
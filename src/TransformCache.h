@@ -0,0 +1,104 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <cstdint>
+#include <list>
+
+#ifndef TRANSFORM_CACHE_BUDGET
+#ifdef ESP_PLATFORM
+#define TRANSFORM_CACHE_BUDGET (32U * 1024U)
+#else
+#define TRANSFORM_CACHE_BUDGET (512U * 1024U)
+#endif
+#endif
+
+struct TransformCacheStats {
+    uint32_t hits;
+    uint32_t misses;        // transforms rendered into the cache
+    uint32_t evictions;
+    uint32_t rejected;      // didn't fit in the budget even after evicting everything unused
+    uint32_t bytesInUse;
+    uint32_t entries;
+};
+
+/**
+ * @brief Cache of already rotated/zoomed images.
+ * @details LVGL resamples a rotated or zoomed image on every redraw that touches it. For static icons
+ *          the result never changes, so it is rendered once (by LVGL's own transform, so the pixels
+ *          are identical) into a true-color+alpha bitmap and the lv_img shows that bitmap untransformed.
+ *
+ *          Entries are keyed by source image, angle, zoom, pivot, object size and color format.
+ *          The cache is bounded by TRANSFORM_CACHE_BUDGET bytes with least-recently-used eviction.
+ *          An entry shown by an object is pinned until that object is deleted.
+ *          The bitmaps are taken with lv_snapshot; a build without LV_USE_SNAPSHOT caches nothing.
+ */
+class TransformedImageCache {
+public:
+    /**
+     * @brief Swaps a rotated/zoomed lv_img over to a cached pre-transformed bitmap, keeping it in the same spot.
+     * @return false if the image isn't transformed or the bitmap didn't fit - the image then stays as it was.
+     * @note  Call it after the final angle/zoom/position are set. Changing them afterwards is not tracked.
+     */
+    static bool applyTo(lv_obj_t* img);
+
+    static void setBudget(uint32_t bytes);
+    static TransformCacheStats getStats();
+
+protected:
+    struct Key {
+        const void* src;
+        int16_t angle;
+        uint16_t zoom;
+        lv_point_t pivot;
+        lv_coord_t w;
+        lv_coord_t h;
+        lv_img_cf_t cf;
+        bool antialias;
+
+        bool operator==(const Key& o) const;
+    };
+
+    struct Entry {
+        Key key;
+        lv_img_dsc_t* img;
+        lv_coord_t ext;     // how far the transformed image reaches outside the object on each side
+        uint32_t bytes;
+        uint16_t refs;
+    };
+
+    static Entry* acquire(const Key& key, lv_obj_t* like);
+    static void release(lv_img_dsc_t* img);
+    static bool makeRoom(uint32_t bytes);
+    static void objDeleted(lv_event_t* e);
+
+    static std::list<Entry> entries;     // front is most recently used
+    static TransformCacheStats stats;
+    static uint32_t budget;
+};
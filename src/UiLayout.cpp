@@ -0,0 +1,374 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "UiLayout.h"
+#include "LazyScreen.h"
+#include "GlyphCache.h"
+#include "WidgetHandle.h"
+
+#ifndef ESP_PLATFORM
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::vector<UiLayout::Binding> UiLayout::bindings;
+
+uint32_t uiLayoutID(const char* name) {
+    return widgetID(name);
+}
+
+UiLayout::UiLayout() : data(nullptr), header(nullptr), widgets(nullptr), props(nullptr), strings(nullptr),
+                       mapped(nullptr), mappedSize(0) {
+}
+
+UiLayout::UiLayout(const uint8_t* _data, uint32_t size) : UiLayout() {
+    load(_data, size);
+}
+
+UiLayout::~UiLayout() {
+    unmap();
+}
+
+bool UiLayout::mapFile(const char* path) {
+#ifdef ESP_PLATFORM
+    (void) path;
+    return false;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    unmap();
+    mapped = map;
+    mappedSize = st.st_size;
+    if (!load((const uint8_t*) map, st.st_size)) {
+        printf("UiLayout: %s is not a valid layout\n", path);
+        unmap();
+        return false;
+    }
+    return true;
+#endif
+}
+
+void UiLayout::unmap() {
+#ifndef ESP_PLATFORM
+    if (mapped)
+        munmap(mapped, mappedSize);
+#endif
+    mapped = nullptr;
+    mappedSize = 0;
+    header = nullptr;
+}
+
+// Everything is checked once here, so building never reads outside the layout.
+bool UiLayout::load(const uint8_t* _data, uint32_t size) {
+    header = nullptr;
+    if (!_data || ((uintptr_t) _data & 3) || size < sizeof(Header))
+        return false;
+
+    const Header* h = (const Header*) _data;
+    if (h->magic != MAGIC || h->version != VERSION || h->totalSize > size || h->totalSize < sizeof(Header)) {
+        printf("UiLayout: bad header (magic %08x, version %u)\n", (unsigned) h->magic, h->version);
+        return false;
+    }
+    uint32_t end = h->totalSize;
+    uint32_t widgetEnd = sizeof(Header) + h->widgetCount * sizeof(Widget);
+    uint32_t propEnd = h->propOffset + h->propCount * sizeof(Prop);
+    uint32_t stringEnd = h->stringOffset + h->stringCount * sizeof(uint32_t);
+    if (widgetEnd > end || h->propOffset < widgetEnd || (h->propOffset & 3) || propEnd > end ||
+        h->stringOffset < propEnd || (h->stringOffset & 3) || stringEnd > end || _data[end - 1] != 0) {
+        printf("UiLayout: tables out of bounds\n");
+        return false;
+    }
+
+    const Widget* w = (const Widget*) (_data + sizeof(Header));
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < h->widgetCount; i++)
+        total += w[i].propCount;
+    const uint32_t* s = (const uint32_t*) (_data + h->stringOffset);
+    for (uint16_t i = 0; i < h->stringCount; i++) {
+        if (s[i] < stringEnd || s[i] >= end)
+            total = ~0u;
+    }
+    if (total != h->propCount) {
+        printf("UiLayout: inconsistent property or string table\n");
+        return false;
+    }
+
+    data = _data;
+    widgets = w;
+    props = (const Prop*) (_data + h->propOffset);
+    strings = s;
+    header = h;
+    return true;
+}
+
+const char* UiLayout::getString(uint16_t index) const {
+    if (!header || index >= header->stringCount)
+        return nullptr;
+    return (const char*) data + strings[index];
+}
+
+////////////////////////////////////////
+//
+//  Bindings
+//
+////////////////////////////////////////
+
+UiLayout::Binding& UiLayout::binding(const char* name) {
+    uint32_t id = uiLayoutID(name);
+    for (Binding& b : bindings) {
+        if (b.id == id)
+            return b;
+    }
+    bindings.push_back({id, nullptr, nullptr, nullptr});
+    return bindings.back();
+}
+
+const UiLayout::Binding* UiLayout::findBinding(uint32_t id) {
+    for (const Binding& b : bindings) {
+        if (b.id == id)
+            return &b;
+    }
+    return nullptr;
+}
+
+void UiLayout::bindCallback(const char* name, std::function<void()> callback) {
+    binding(name).callback = callback;
+}
+
+void UiLayout::bindStyle(const char* name, lv_style_t* style) {
+    binding(name).style = style;
+}
+
+void UiLayout::bindImage(const char* name, const lv_img_dsc_t* image) {
+    binding(name).image = image;
+}
+
+////////////////////////////////////////
+//
+//  Building
+//
+////////////////////////////////////////
+
+bool UiLayout::build(LazyScreen& screen) const {
+    return instantiate([&screen](lvppBase* widget) {
+        screen.adopt(widget);
+        screen.addObject(widget);
+    });
+}
+
+bool UiLayout::build(lvppScreen* screen, std::vector<lvppBase*>& created) const {
+    return instantiate([screen, &created](lvppBase* widget) {
+        created.push_back(widget);
+        screen->addObject(widget);
+    });
+}
+
+bool UiLayout::instantiate(std::function<void(lvppBase*)> adopt) const {
+    if (!header)
+        return false;
+
+    const Prop* p = props;
+    for (uint16_t i = 0; i < header->widgetCount; i++) {
+        const Widget& w = widgets[i];
+        if (w.type == DEFAULTS) {
+            applyDefaults(p, w.propCount);
+        } else {
+            lvppBase* widget = createWidget(w);
+            if (widget) {
+                applyProps(widget, w.type, p, w.propCount);
+                adopt(widget);
+            }
+        }
+        p += w.propCount;
+    }
+    return true;
+}
+
+// Registered under their concrete type, so WidgetHandle<lvppBar>::find() works for layout widgets too.
+template <class T>
+static lvppBase* registered(T* widget) {
+    WidgetHandle<T>::of(widget);
+    return widget;
+}
+
+lvppBase* UiLayout::createWidget(const Widget& w) const {
+    const char* name = getString(w.name);
+    const char* text = getString(w.text);
+    if (!name) {
+        printf("UiLayout: widget without a name skipped\n");
+        return nullptr;
+    }
+
+    switch (w.type) {
+        case LABEL:         return registered(new lvppLabel(name, text));
+        case BUTTON:        return registered(new lvppButton(name, text));
+        case BAR:           return registered(new lvppBar(name));
+        case SWITCH:        return registered(new lvppSwitch(name));
+        case DROPDOWN:      return registered(new lvppDropdown(name, text));
+        case CYCLEBUTTON:   return registered(new lvppCycleButton(name));
+        case ARC:           return registered(new lvppArc(name));
+        case IMAGE:         return registered(new lvppImage(name));
+        default:
+            printf("UiLayout: unknown widget type %u for %s\n", w.type, name);
+            return nullptr;
+    }
+}
+
+void UiLayout::applyDefaults(const Prop* p, uint16_t count) const {
+    for (uint16_t i = 0; i < count; i++, p++) {
+        switch (p->op) {
+            case DEFAULT_FONT_SIZE:         lvppBase::setDefaultFont(fontForSize(p->a)); break;
+            case DEFAULT_BG_COLOR:          lvppBase::setDefaultBGColor(toColor(p->b)); break;
+            case DEFAULT_TEXT_COLOR:        lvppBase::setDefaultTextColor(toColor(p->b)); break;
+            case REMOVE_DEFAULT_BG_COLOR:   lvppBase::removeDefaultBGColor(); break;
+            default:
+                printf("UiLayout: op %u is not a default\n", p->op);
+                break;
+        }
+    }
+}
+
+void UiLayout::applyProps(lvppBase* widget, uint8_t type, const Prop* p, uint16_t count) const {
+    for (uint16_t i = 0; i < count; i++, p++) {
+        const char* str = getString(p->a);
+        const Binding* bound = nullptr;
+        if (p->op == ON_CLICKED || p->op == ON_VALUE_CHANGED || p->op == STYLE || p->op == IMAGE_SRC) {
+            bound = findBinding((uint32_t) p->b);
+            if (!bound) {
+                printf("UiLayout: %s refers to an unbound id %08x\n", widget->getName(), (unsigned) p->b);
+                continue;
+            }
+        }
+
+        switch (p->op) {
+            case ALIGN:         widget->align((lv_align_t) p->a, p->b, p->c); break;
+            case SIZE:          widget->setSize(p->b, p->c); break;
+            case TEXT:          if (str) widget->setText(str); break;
+            case FONT_SIZE:     widget->setFontSize(p->a); break;
+            case BG_COLOR:      widget->setBGColor(toColor(p->b)); break;
+            case TEXT_COLOR:    widget->setTextColor(toColor(p->b)); break;
+            case GRADIENT:      widget->setColorGradient(toColor(p->b), toColor(p->c), (lv_grad_dir_t) p->a); break;
+            case RANGE:         widget->setRange(p->b, p->c); break;
+            case VALUE:         widget->setValue(p->b); break;
+            case ADJ_TEXT:      if (str) widget->setAdjText(str, p->b, p->c); break;
+            case ADJ_BG_COLOR:  widget->setAdjBGColor(toColor(p->b)); break;
+            case VALUE_LABEL:   widget->enableValueLabel(p->b, p->c, (lv_align_t) p->a); break;
+            case VALUE_LABEL_FORMAT:    if (str) widget->setValueLabelFormat(str); break;
+            case ON_CLICKED:    widget->setCallbackOnClicked(bound->callback); break;
+            case ON_VALUE_CHANGED:      widget->setCallbackOnValueChanged(bound->callback); break;
+            case STYLE:         if (bound->style) lv_obj_add_style(widget->getObj(), bound->style, 0); break;
+            case OPTIONS:
+                if (type == DROPDOWN && str)
+                    ((lvppDropdown*) widget)->setOptions(str);
+                break;
+            case OPTION:
+                if (type == CYCLEBUTTON && str)
+                    ((lvppCycleButton*) widget)->addOptionWithID(str, p->b);
+                break;
+            case DROPDOWN_DIR:
+                if (type == DROPDOWN)
+                    ((lvppDropdown*) widget)->setDropdownDirection((lv_dir_t) p->a);
+                break;
+            case CHECKED:
+                if (type == SWITCH)
+                    ((lvppSwitch*) widget)->setCheckedState(p->a != 0);
+                break;
+            case IMAGE_SRC:
+                if (type == IMAGE && bound->image)
+                    ((lvppImage*) widget)->setImage(bound->image);
+                break;
+            case ROTATION:
+                if (type == IMAGE)
+                    ((lvppImage*) widget)->setRotation(p->b);
+                break;
+            default:
+                printf("UiLayout: %s has unknown op %u\n", widget->getName(), p->op);
+                break;
+        }
+    }
+}
+
+// Literal colors are 0x00RRGGBB, palette colors 0x01 | palette << 16 | mode << 8 | level
+lv_color_t UiLayout::toColor(int32_t encoded) {
+    uint32_t c = (uint32_t) encoded;
+    if ((c >> 24) != 0x01)
+        return lv_color_hex(c & 0xFFFFFF);
+
+    lv_palette_t palette = (lv_palette_t) ((c >> 16) & 0xFF);
+    uint8_t level = c & 0xFF;
+    switch ((c >> 8) & 0xFF) {
+        case 1:     return lv_palette_lighten(palette, level);
+        case 2:     return lv_palette_darken(palette, level);
+        default:    return lv_palette_main(palette);
+    }
+}
+
+const lv_font_t* UiLayout::fontForSize(uint16_t size) {
+    const lv_font_t* font = LV_FONT_DEFAULT;
+    switch (size) {
+#if LV_FONT_MONTSERRAT_12
+        case 12:    font = &lv_font_montserrat_12; break;
+#endif
+#if LV_FONT_MONTSERRAT_14
+        case 14:    font = &lv_font_montserrat_14; break;
+#endif
+#if LV_FONT_MONTSERRAT_16
+        case 16:    font = &lv_font_montserrat_16; break;
+#endif
+#if LV_FONT_MONTSERRAT_18
+        case 18:    font = &lv_font_montserrat_18; break;
+#endif
+#if LV_FONT_MONTSERRAT_20
+        case 20:    font = &lv_font_montserrat_20; break;
+#endif
+#if LV_FONT_MONTSERRAT_22
+        case 22:    font = &lv_font_montserrat_22; break;
+#endif
+#if LV_FONT_MONTSERRAT_24
+        case 24:    font = &lv_font_montserrat_24; break;
+#endif
+#if LV_FONT_MONTSERRAT_32
+        case 32:    font = &lv_font_montserrat_32; break;
+#endif
+        default:
+            printf("UiLayout: no %u pt font, using the default\n", size);
+            break;
+    }
+    return GlyphCache::wrap(font);
+}
@@ -0,0 +1,171 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <functional>
+#include <vector>
+
+class LazyScreen;
+
+// Where the emulator looks for compiled layouts (relative to the working directory).
+#ifndef UI_LAYOUT_DIR
+#define UI_LAYOUT_DIR "layouts"
+#endif
+
+/**
+ * @brief Identifier for a callback, style or image a layout refers to - FNV-1a of its name.
+ *        support/layout_compiler.py computes the same hash.
+ */
+uint32_t uiLayoutID(const char* name);
+
+/**
+ * @brief A screen layout in the binary format written by support/layout_compiler.py.
+ * @details The layout is read in place: from a const array (generated into src/<Name>Layout.h, which on the
+ *          ESP32 stays in memory-mapped flash) or from a file mmap()ed by mapFile() on the emulator, so a
+ *          layout edit only needs the compiler run, not a rebuild. Widget names point into the layout, so
+ *          it must outlive the widgets built from it.
+ *
+ *          Callbacks, styles and images are referenced by name and bound in code before building:
+ * @code
+ *     UiLayout::bindCallback("exitSetup", []() { pScreenMain->activateScreen(); });
+ *     static UiLayout setup(setupLayout, sizeof(setupLayout));
+ *     pScreenSetup = new LazyScreen("setup screen", [](LazyScreen& screen) { setup.build(screen); });
+ * @endcode
+ */
+class UiLayout {
+public:
+    static const uint32_t MAGIC = 0x4C50564C;     // "LVPL"
+    static const uint16_t VERSION = 1;
+    static const uint16_t NO_STRING = 0xFFFF;
+
+    // Keep in step with support/layout_compiler.py
+    enum WidgetType : uint8_t {
+        DEFAULTS = 0, LABEL, BUTTON, BAR, SWITCH, DROPDOWN, CYCLEBUTTON, ARC, IMAGE
+    };
+
+    enum Op : uint8_t {
+        ALIGN = 1, SIZE, TEXT, FONT_SIZE, BG_COLOR, TEXT_COLOR, GRADIENT, RANGE, VALUE, OPTIONS, OPTION,
+        ADJ_TEXT, ADJ_BG_COLOR, VALUE_LABEL, VALUE_LABEL_FORMAT, ON_CLICKED, ON_VALUE_CHANGED, STYLE,
+        CHECKED, DROPDOWN_DIR, IMAGE_SRC, ROTATION,
+        DEFAULT_FONT_SIZE = 40, DEFAULT_BG_COLOR, DEFAULT_TEXT_COLOR, REMOVE_DEFAULT_BG_COLOR
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t widgetCount;
+        uint32_t propOffset;
+        uint16_t propCount;
+        uint16_t stringCount;
+        uint32_t stringOffset;
+        uint32_t totalSize;
+    };
+
+    struct Widget {
+        uint8_t type;
+        uint8_t reserved;
+        uint16_t name;
+        uint16_t text;
+        uint16_t propCount;
+    };
+
+    struct Prop {
+        uint8_t op;
+        uint8_t reserved;
+        uint16_t a;
+        int32_t b;
+        int32_t c;
+    };
+
+    /**
+     * @brief Uses the layout at data in place. Check isValid() before building.
+     */
+    UiLayout(const uint8_t* data, uint32_t size);
+    UiLayout();
+    ~UiLayout();
+    UiLayout(const UiLayout&) = delete;
+    UiLayout& operator=(const UiLayout&) = delete;
+
+    /**
+     * @brief Switches to the layout at data (4-byte aligned), used in place. False if it fails validation.
+     */
+    bool load(const uint8_t* data, uint32_t size);
+
+    /**
+     * @brief Maps a compiled .bin read-only. Native builds only - on the ESP32 this returns false and
+     *        the layout linked into flash is used instead.
+     */
+    bool mapFile(const char* path);
+
+    bool isValid() const { return header != nullptr; };
+    uint16_t getWidgetCount() const { return header ? header->widgetCount : 0; };
+    const char* getString(uint16_t index) const;
+
+    /**
+     * @brief Creates the layout's widgets on a lazy screen, which owns them.
+     */
+    bool build(LazyScreen& screen) const;
+
+    /**
+     * @brief Creates the layout's widgets on screen. They are appended to created; the caller deletes them.
+     */
+    bool build(lvppScreen* screen, std::vector<lvppBase*>& created) const;
+
+    static void bindCallback(const char* name, std::function<void()> callback);
+    static void bindStyle(const char* name, lv_style_t* style);
+    static void bindImage(const char* name, const lv_img_dsc_t* image);
+
+protected:
+    void unmap();
+    bool instantiate(std::function<void(lvppBase*)> adopt) const;
+    lvppBase* createWidget(const Widget& w) const;
+    void applyDefaults(const Prop* props, uint16_t count) const;
+    void applyProps(lvppBase* widget, uint8_t type, const Prop* props, uint16_t count) const;
+
+    static lv_color_t toColor(int32_t encoded);
+    static const lv_font_t* fontForSize(uint16_t size);
+
+    struct Binding {
+        uint32_t id;
+        std::function<void()> callback;
+        lv_style_t* style;
+        const lv_img_dsc_t* image;
+    };
+    static const Binding* findBinding(uint32_t id);
+    static Binding& binding(const char* name);
+    static std::vector<Binding> bindings;
+
+    const uint8_t* data;
+    const Header* header;
+    const Widget* widgets;
+    const Prop* props;
+    const uint32_t* strings;
+    void* mapped;
+    uint32_t mappedSize;
+};
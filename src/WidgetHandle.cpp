@@ -0,0 +1,134 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#include "WidgetHandle.h"
+
+// Index entries are slot + 1, so the zeroed table starts out empty.
+static const uint16_t EMPTY = 0;
+static const uint16_t REMOVED = 0xFFFF;
+
+WidgetRegistry::Slot WidgetRegistry::slots[WIDGET_REGISTRY_SIZE];
+uint16_t WidgetRegistry::index[WIDGET_REGISTRY_SIZE * 2];
+uint16_t WidgetRegistry::used = 0;
+uint16_t WidgetRegistry::removed = 0;
+
+// Open addressing on the name ID. The table is twice the slot count and rebuilt when removals pile up,
+// so a probe ends at an empty entry after a few steps.
+uint16_t* WidgetRegistry::bucket(uint32_t id, bool forInsert) {
+    const uint32_t size = WIDGET_REGISTRY_SIZE * 2;
+    uint32_t i = id % size;
+    uint16_t* firstRemoved = nullptr;
+    for (uint32_t n = 0; n < size; n++, i = (i + 1) % size) {
+        uint16_t& b = index[i];
+        if (b == EMPTY)
+            return (forInsert && firstRemoved) ? firstRemoved : &b;
+        if (b == REMOVED) {
+            if (!firstRemoved)
+                firstRemoved = &b;
+        } else if (slots[b - 1].id == id) {
+            return &b;
+        }
+    }
+    return forInsert ? firstRemoved : nullptr;
+}
+
+void WidgetRegistry::rebuildIndex() {
+    for (uint16_t& b : index)
+        b = EMPTY;
+    removed = 0;
+    for (uint16_t i = 0; i < WIDGET_REGISTRY_SIZE; i++) {
+        if (slots[i].widget) {
+            uint16_t* b = bucket(slots[i].id, true);
+            if (*b == EMPTY)
+                *b = i + 1;
+        }
+    }
+}
+
+int16_t WidgetRegistry::add(lvppBase* widget, const void* type) {
+    if (!widget)
+        return -1;
+    uint32_t id = widgetID(widget->getName());
+    uint16_t* b = bucket(id, true);
+    bool named = *b != EMPTY && *b != REMOVED;
+    if (named) {
+        if (slots[*b - 1].widget == widget)
+            return *b - 1;
+        printf("WidgetRegistry: name %s is registered twice - lookups find the first\n", widget->getName());
+    }
+
+    int16_t freeSlot = -1;
+    for (uint16_t i = 0; i < WIDGET_REGISTRY_SIZE; i++) {
+        if (!slots[i].widget) {
+            freeSlot = i;
+            break;
+        }
+    }
+    if (freeSlot < 0) {
+        printf("WidgetRegistry: full (WIDGET_REGISTRY_SIZE %u), %s has no handle\n", WIDGET_REGISTRY_SIZE, widget->getName());
+        return -1;
+    }
+
+    Slot& s = slots[freeSlot];
+    s.widget = widget;
+    s.type = type;
+    s.id = id;
+    if (!named) {
+        if (*b == REMOVED)
+            removed--;
+        *b = freeSlot + 1;
+    }
+    used++;
+
+    lv_obj_add_event_cb(widget->getObj(), deleteEvent, LV_EVENT_DELETE, (void*) (intptr_t) freeSlot);
+    return freeSlot;
+}
+
+int16_t WidgetRegistry::find(uint32_t id) {
+    uint16_t* b = bucket(id, false);
+    return (b && *b != EMPTY && *b != REMOVED) ? *b - 1 : -1;
+}
+
+void WidgetRegistry::remove(uint16_t i) {
+    Slot& s = slots[i];
+    if (!s.widget)
+        return;
+    uint16_t* b = bucket(s.id, false);
+    s.widget = nullptr;
+    s.type = nullptr;
+    s.generation++;
+    used--;
+    if (b && *b == i + 1) {
+        *b = REMOVED;
+        if (++removed > WIDGET_REGISTRY_SIZE / 2)
+            rebuildIndex();
+    }
+}
+
+void WidgetRegistry::deleteEvent(lv_event_t* e) {
+    remove((uint16_t) (intptr_t) lv_event_get_user_data(e));
+}
@@ -0,0 +1,149 @@
+// Copyright 2023 Robert M. Wolff (bob dot wolff 68 at gmail dot com)
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this 
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or 
+// other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors 
+// may be used to endorse or promote products derived from this software without 
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "lvpp.h"
+#include <type_traits>
+
+// Most widgets registered at once (all screens). Slots of deleted widgets are reused.
+#ifndef WIDGET_REGISTRY_SIZE
+#ifdef ESP_PLATFORM
+#define WIDGET_REGISTRY_SIZE 64
+#else
+#define WIDGET_REGISTRY_SIZE 1024
+#endif
+#endif
+
+/**
+ * @brief FNV-1a of a widget name. constexpr, so WIDGET_ID("H2OLevel") costs nothing at run time.
+ */
+constexpr uint32_t widgetID(const char* name, uint32_t hash = 0x811C9DC5) {
+    return *name ? widgetID(name + 1, (hash ^ (uint8_t) *name) * 0x01000193u) : hash;
+}
+
+// Forces the hash to be computed by the compiler.
+#define WIDGET_ID(name) (std::integral_constant<uint32_t, widgetID(name)>::value)
+
+/**
+ * @brief Registered widgets, by slot (for handles) and by name ID (for the few remaining lookups).
+ * @details Widgets are added by StaticWidget::init(), LazyScreen::addObject() and UiLayout, i.e. everything
+ *          that is put on a screen. The slot is freed when the widget's LVGL object is deleted, which also
+ *          bumps the slot's generation so that stale handles resolve to nullptr instead of a dangling
+ *          pointer. Like the widgets themselves, it's only touched with the LVGL lock held.
+ */
+class WidgetRegistry {
+public:
+    struct Slot {
+        lvppBase* widget;
+        const void* type;
+        uint32_t id;
+        uint16_t generation;
+    };
+
+    template <class T>
+    static const void* typeTag() {
+        static const char tag = 0;
+        return &tag;
+    };
+
+    /**
+     * @brief Registers widget under its name. Returns the slot, or -1 if the registry is full.
+     */
+    static int16_t add(lvppBase* widget, const void* type);
+
+    /**
+     * @brief Slot of the widget registered under id, or -1.
+     */
+    static int16_t find(uint32_t id);
+
+    static Slot& slot(uint16_t index) { return slots[index]; };
+    static uint16_t count() { return used; };
+
+protected:
+    static void remove(uint16_t index);
+    static void deleteEvent(lv_event_t* e);
+    static uint16_t* bucket(uint32_t id, bool forInsert);
+    static void rebuildIndex();
+
+    static Slot slots[WIDGET_REGISTRY_SIZE];
+    static uint16_t index[WIDGET_REGISTRY_SIZE * 2];
+    static uint16_t used;
+    static uint16_t removed;
+};
+
+/**
+ * @brief A constant time reference to a registered widget of type T.
+ * @details Resolve it once - from the widget itself or by WIDGET_ID() - and keep it. get() is an array
+ *          index and a generation compare; it returns nullptr once the widget has been deleted (e.g. a
+ *          released LazyScreen), and keeps returning nullptr after the slot is reused.
+ * @code
+ *     WidgetHandle<lvppBar> water = WidgetHandle<lvppBar>::find(WIDGET_ID("H2OLevel"));
+ *     if (lvppBar* bar = water.get())
+ *         bar->setValue(level);
+ * @endcode
+ */
+template <class T>
+class WidgetHandle {
+public:
+    WidgetHandle() : slot(-1), generation(0) {};
+
+    /**
+     * @brief Registers widget (if it isn't yet) and returns its handle.
+     */
+    static WidgetHandle of(T* widget) {
+        return WidgetHandle(WidgetRegistry::add(widget, WidgetRegistry::typeTag<T>()));
+    };
+
+    /**
+     * @brief The widget registered under id, if it was registered as exactly T (any widget for lvppBase).
+     *        Otherwise an empty handle.
+     */
+    static WidgetHandle find(uint32_t id) {
+        int16_t index = WidgetRegistry::find(id);
+        if (index >= 0 && !std::is_same<T, lvppBase>::value &&
+            WidgetRegistry::slot(index).type != WidgetRegistry::typeTag<T>())
+            index = -1;
+        return WidgetHandle(index);
+    };
+
+    T* get() const {
+        if (slot < 0)
+            return nullptr;
+        const WidgetRegistry::Slot& s = WidgetRegistry::slot(slot);
+        return s.generation == generation ? static_cast<T*>(s.widget) : nullptr;
+    };
+
+    T* operator->() const { return get(); };
+    explicit operator bool() const { return get() != nullptr; };
+
+protected:
+    explicit WidgetHandle(int16_t index) : slot(index), generation(index >= 0 ? WidgetRegistry::slot(index).generation : 0) {};
+
+    int16_t slot;
+    uint16_t generation;
+};
@@ -27,9 +27,74 @@
 //
 #include "main_header.h"
 #include "Widgets.h"
+#include "BitmapCache.h"
+#include "TransformCache.h"
+#include "GlyphCache.h"
+#include "HeapScope.h"
+#include "LazyScreen.h"
+#include "BootProfiler.h"
+#include "CanvasFormat.h"
+#include "UiLayout.h"
+#include "StaticWidgets.h"
+#include "ScreenTransition.h"
+#include "SetupLayout.h"
+#include "TelemetryLog.h"
 
 
 
+////////////////////////////////////////
+//
+//  MAIN SCREEN DEFINITION
+//
+//  Everything known at compile time is a constexpr WidgetDef (read-only data), and every widget object
+//  lives in static storage. instantiateWidgets() is the only code that runs: it builds them in place.
+//
+////////////////////////////////////////
+
+namespace {
+
+const lv_coord_t topYarea = 117;
+const lv_coord_t botXdivider = 158;
+
+constexpr WidgetDef fullnessBarDef = WidgetDef("H2OLevel").size(13, 80).at(LV_ALIGN_TOP_RIGHT, -19, 20)
+    .limits(0, 100).valueText("%d%%", 2, 17, LV_ALIGN_BOTTOM_MID).value(20)
+    .gradient(WidgetColor::fromPalette(LV_PALETTE_BLUE, -3), WidgetColor::fromPalette(LV_PALETTE_BROWN, 1), LV_GRAD_DIR_VER)
+    .adjText("Water", 0, -50);
+
+constexpr WidgetDef plus5Def = WidgetDef("+5Min", "  Add\n+1 Min").size(70, 55).at(LV_ALIGN_TOP_MID, 0, 7)
+    .font(20).bg(WidgetColor::fromPalette(LV_PALETTE_GREEN, 1));
+
+constexpr WidgetDef lightsDef = WidgetDef("Lights").size(61, 28).at(LV_ALIGN_TOP_LEFT, 6, 35)
+    .adjText("Lights", 0, -24);
+
+constexpr WidgetDef arrowDef = WidgetDef("arrow").size(40, 40).at(LV_ALIGN_TOP_MID, 75, 1);
+
+constexpr WidgetDef dropCycleDef = WidgetDef("DropCycle").size(148, 42).at(LV_ALIGN_BOTTOM_LEFT, 5, -40)
+    .font(22).bg(WidgetColor::fromPalette(LV_PALETTE_BLUE, -1)).adjText("Cycle Pulsing", 0, -32);
+
+constexpr WidgetDef camSwitchDef = WidgetDef("cam").at(LV_ALIGN_LEFT_MID, 10, -35).size(40, 20)
+    .adjText("Camera", 0, 20);
+
+constexpr WidgetDef setupButtonDef = WidgetDef("Setup", LV_SYMBOL_SETTINGS " Setup").at(LV_ALIGN_BOTTOM_RIGHT, -3, -3);
+
+StaticSlot<lvppScreen> screenMain;
+StaticSlot<lvppCanvasIndexed> bground;
+StaticWidget<lvppBar> fullnessBar;
+StaticWidget<lvppButton> plus5;
+StaticWidget<lvppCycleButton> lights;
+StaticWidget<lvppImage> arrow;
+StaticWidget<lvppDropdown> dropCycle;
+StaticSlot<TimeStatus> timeStatus;
+StaticSlot<TempGauge> tempGauge;
+StaticSlot<HistoryChart> tempHistory;
+StaticSlot<HistoryChart> waterHistory;
+StaticWidget<lvppSwitch> camSwitch;
+StaticWidget<lvppButton> setupButton;
+StaticSlot<LazyScreen> screenSetup;
+StaticSlot<UiLayout> setupScreenLayout;
+
+}
+
 ////////////////////////////////////////
 //
 //  instantiateWidgets
@@ -37,168 +102,134 @@
 ////////////////////////////////////////
 
 void instantiateWidgets(void) {
-    pScreenMain = new lvppScreen(lv_scr_act());
-
-    static lvppCanvasIndexed bground("back2", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 4);
-    const lv_coord_t topYarea = 117;
-    const lv_coord_t botXdivider = 158;
-
-    bground.addColorToIndex(lv_color_white());
-    bground.addColorToIndex(lv_color_black());
-    bground.addPaletteToIndex(LV_PALETTE_BLUE_GREY);
-
-    bground.setbgColor(lv_palette_lighten(LV_PALETTE_BLUE_GREY, 1));
-    bground.drawLineHoriz(0,topYarea, SCREEN_WIDTH, lv_color_black());
-    bground.drawLineVert(botXdivider, topYarea, SCREEN_HEIGHT-topYarea, lv_color_black());
-
-    pScreenMain->addObject(&bground);
-
-    static lvppBar fullnessBar("H2OLevel");
-    fullnessBar.setSize(13, 80);
-    fullnessBar.align(LV_ALIGN_TOP_RIGHT, -19, 20);
-    fullnessBar.setRange(0,100);
-    fullnessBar.setValueLabelFormat("%d%%");
-    fullnessBar.enableValueLabel(2, 17, LV_ALIGN_BOTTOM_MID);
-    fullnessBar.setValue(20);
-    fullnessBar.setColorGradient(lv_palette_darken(LV_PALETTE_BLUE, 3), lv_palette_lighten(LV_PALETTE_BROWN, 1), LV_GRAD_DIR_VER);
-    fullnessBar.setAdjText("Water", 0, -50);
-
-    pScreenMain->addObject(&fullnessBar);
-
-    printf("size of buffer for TRUE_COLOR:%d\n", LV_CANVAS_BUF_SIZE_TRUE_COLOR(320,240));
-    printf("size of buffer for INDEXED 8-bit:%d\n", LV_CANVAS_BUF_SIZE_INDEXED_8BIT(320,240));
-    printf("size of buffer for INDEXED 4-bit:%d\n", LV_CANVAS_BUF_SIZE_INDEXED_4BIT(320,240));
-
-    static lvppButton plus5("+5Min", "  Add\n+1 Min");
-    plus5.setSize(70, 55);
-    plus5.align(LV_ALIGN_TOP_MID, 0, 7);
-    plus5.setFontSize(20);
-    plus5.setBGColor(lv_palette_lighten(LV_PALETTE_GREEN, 1));
-    plus5.setCallbackOnClicked([]() -> void {
+    HeapScope mainScope("main screen");
+    pScreenMain = &screenMain.construct(lv_scr_act());
+
+    BootProfiler::begin("bground");
+    // White, black and the blue-grey palette (main + 5 lighter + 4 darker) - 12 colors. The budget decides
+    // between the smallest indexed depth, 8-bit indexing and an extra true-color copy to blit from.
+    const CanvasFormatChoice bgFormat = chooseCanvasFormat(SCREEN_WIDTH, SCREEN_HEIGHT, 12, BG_CANVAS_BUDGET);
+    bground.construct("back2", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, bgFormat.indexedBpp);
+
+    bground->addColorToIndex(lv_color_white());
+    bground->addColorToIndex(lv_color_black());
+    bground->addPaletteToIndex(LV_PALETTE_BLUE_GREY);
+
+    bground->setbgColor(lv_palette_lighten(LV_PALETTE_BLUE_GREY, 1));
+    bground->drawLineHoriz(0,topYarea, SCREEN_WIDTH, lv_color_black());
+    bground->drawLineVert(botXdivider, topYarea, SCREEN_HEIGHT-topYarea, lv_color_black());
+
+    pScreenMain->addObject(bground.get());
+    // Never changes after this, so the true-color copy (if chosen) can be made now.
+    applyCanvasFormat(*bground, bgFormat);
+    printf("Background canvas: %s, %u bytes (budget %u)\n", canvasFormatName(bgFormat), (unsigned)bgFormat.bytes, (unsigned)BG_CANVAS_BUDGET);
+
+    BootProfiler::next("fullnessBar");
+    fullnessBar.init(fullnessBarDef, pScreenMain);
+
+    BootProfiler::next("plus5");
+    plus5.init(plus5Def, pScreenMain);
+    plus5->setCallbackOnClicked([]() -> void {
         assert(pTheBrain);
+        TelemetryLog::logEvent(LV_EVENT_CLICKED, WIDGET_ID("+5Min"));
         pTheBrain->AddSeconds(60);
     });
-
-    pScreenMain->addObject(&plus5);
-
-    static lvppCycleButton lights("Lights");
-    lights.setSize(61, 28);
-    lights.align(LV_ALIGN_TOP_LEFT, 6, 35);
-    lights.addOptionWithID(LV_SYMBOL_POWER " Off", 500);
-    lights.addOptionWithID(LV_SYMBOL_SHUFFLE " Slow", 700);
-    lights.addOptionWithID(LV_SYMBOL_SHUFFLE " Fast", 900);
-    lights.setAdjText("Lights", 0, -24);
-    lights.setCallbackOnClicked([]() {
-        uint64_t id = lights.getSelectedID();
-        uint16_t index = lights.getSelectedIndex();
+    cacheAsBitmap(*plus5);
+
+    BootProfiler::next("lights");
+    lights.init(lightsDef, nullptr);
+    lights->addOptionWithID(LV_SYMBOL_POWER " Off", 500);
+    lights->addOptionWithID(LV_SYMBOL_SHUFFLE " Slow", 700);
+    lights->addOptionWithID(LV_SYMBOL_SHUFFLE " Fast", 900);
+    lights->setCallbackOnClicked([]() {
+        uint64_t id = lights->getSelectedID();
+        uint16_t index = lights->getSelectedIndex();
+        TelemetryLog::logEvent(LV_EVENT_VALUE_CHANGED, WIDGET_ID("Lights"));
         printf("Cycle Button changed. New index:%d, new ID value is: %llu\n", index, id);
     });
+    pScreenMain->addObject(lights.get());
 
-    pScreenMain->addObject(&lights);
-
+    BootProfiler::next("arrow");
     LV_IMG_DECLARE(arrow_upward);
-    static lvppImage arrow("arrow");
-    arrow.setSize(40,40);
-    arrow.setImage(&arrow_upward);
-    arrow.align(LV_ALIGN_TOP_MID, 75, 1);
-    arrow.setRotation(150);
-    pScreenMain->addObject(&arrow);
-
-    static lvppDropdown dropCycle("DropCycle");
-    dropCycle.setSize(148, 42);
-    dropCycle.align(LV_ALIGN_BOTTOM_LEFT, 5, -40);
-    dropCycle.setFontSize(22);
-    dropCycle.setBGColor(lv_palette_darken(LV_PALETTE_BLUE, 1));
-    dropCycle.setOptions(LV_SYMBOL_REFRESH " All On\n" LV_SYMBOL_REFRESH " 2 Secs\n" LV_SYMBOL_REFRESH " 3 Secs\n" LV_SYMBOL_REFRESH " 4 Secs");
-    dropCycle.setDropdownDirection(LV_DIR_TOP);
-    dropCycle.setAdjText("Cycle Pulsing", 0, -32);
-
-    pScreenMain->addObject(&dropCycle);
-
-    pTimeStatus = new TimeStatus;
+    arrow.init(arrowDef, pScreenMain);
+    arrow->setImage(&arrow_upward);
+    arrow->setRotation(150);
+    // The rotation never changes, so draw the rotated pixels once instead of resampling on every redraw.
+    TransformedImageCache::applyTo(arrow->getObj());
+
+    BootProfiler::next("dropCycle");
+    dropCycle.init(dropCycleDef, pScreenMain);
+    dropCycle->setOptions(LV_SYMBOL_REFRESH " All On\n" LV_SYMBOL_REFRESH " 2 Secs\n" LV_SYMBOL_REFRESH " 3 Secs\n" LV_SYMBOL_REFRESH " 4 Secs");
+    dropCycle->setDropdownDirection(LV_DIR_TOP);
+
+    BootProfiler::next("TimeStatus");
+    pTimeStatus = &timeStatus.construct();
     pScreenMain->addObject(pTimeStatus);
 
-    pTempGauge = new TempGauge;
+    BootProfiler::next("TempGauge");
+    pTempGauge = &tempGauge.construct();
     pScreenMain->addObject(pTempGauge);
 
-    static lvppSwitch camSwitch("cam");
-    camSwitch.align(LV_ALIGN_LEFT_MID, 10, -35);
-    camSwitch.setSize(40, 20);
-    camSwitch.setAdjText("Camera", 0, 20);
-    camSwitch.setCheckedState(true);
-//    camSwitch.setEnabled(false);
-    camSwitch.setCallbackOnValueChanged([]() {
-        if (camSwitch.getCheckedState())
+    // TheBrain appends every run (one display period), HISTORY_COLUMN_MS of samples to a column.
+    BootProfiler::next("history charts");
+    const uint16_t samplesPerColumn = HISTORY_COLUMN_MS / LV_DISP_DEF_REFR_PERIOD;
+    pTempHistory = &tempHistory.construct("TempHistory", 50, 50, 50, TEMP_GAUGE_MAX, samplesPerColumn);
+    pTempHistory->align(LV_ALIGN_TOP_LEFT, 71, 8);
+    pTempHistory->setColors(lv_palette_main(LV_PALETTE_DEEP_ORANGE), lv_palette_lighten(LV_PALETTE_BLUE_GREY, 4));
+    pScreenMain->addObject(pTempHistory);
+    pWaterHistory = &waterHistory.construct("WaterHistory", 40, 56, 0, 100, samplesPerColumn);
+    pWaterHistory->align(LV_ALIGN_TOP_LEFT, 242, 48);
+    pWaterHistory->setColors(lv_palette_darken(LV_PALETTE_BLUE, 1), lv_palette_lighten(LV_PALETTE_BLUE_GREY, 4));
+    pScreenMain->addObject(pWaterHistory);
+
+    BootProfiler::next("camSwitch");
+    camSwitch.init(camSwitchDef, nullptr);
+    camSwitch->setCheckedState(true);
+//    camSwitch->setEnabled(false);
+    camSwitch->setCallbackOnValueChanged([]() {
+        TelemetryLog::logEvent(LV_EVENT_VALUE_CHANGED, WIDGET_ID("cam"));
+        if (camSwitch->getCheckedState())
             printf("CamSwitch is now ON.\n");
         else
             printf("CamSwitch is now OFF.\n");
     });
 
-    static lvppButton setupButton("Setup", LV_SYMBOL_SETTINGS" Setup");
-    setupButton.align(LV_ALIGN_BOTTOM_RIGHT, -3, -3);
-    setupButton.setCallbackOnClicked([]() -> void {
+    BootProfiler::next("setupButton");
+    setupButton.init(setupButtonDef, pScreenMain);
+    setupButton->setCallbackOnClicked([]() -> void {
         // Time to load the setup screen.
+        TelemetryLog::logEvent(LV_EVENT_CLICKED, WIDGET_ID("Setup"));
         if (pScreenSetup) {
             pScreenSetup->activateScreen(500, LV_SCR_LOAD_ANIM_OVER_LEFT);
         }
     });
-
-    pScreenMain->addObject(&setupButton);
+    cacheAsBitmap(*setupButton);
+    BootProfiler::end();
 
 ////////////////////////////////////////
 //
 //  SETUP SCREEN ITEMS - JUST A FEW
 //
+//  Rarely shown, so it is only built the first time the Setup button is pressed, and on the ESP32
+//  released again LAZY_SCREEN_RELEASE_MS after leaving it.
+//
 ////////////////////////////////////////
-    pScreenSetup = new lvppScreen();
-    
-    static lvppLabel hello("title", "Setup Screen Example");
-    hello.align(LV_ALIGN_TOP_MID, 0, 3);
-
-    pScreenSetup->addObject(&hello);
-
-    lvppBase::setDefaultFont(&lv_font_montserrat_22);
-    lvppBase::setDefaultBGColor(lv_palette_lighten(LV_PALETTE_GREEN, 2));
-    lvppBase::setDefaultTextColor(lv_palette_darken(LV_PALETTE_DEEP_ORANGE, 1));
-
-    static lvppLabel biggerDefLabel("def1", "Test 22pt orange/green");
-    biggerDefLabel.align(LV_ALIGN_CENTER, 0, -60);
-    biggerDefLabel.setColorGradient(lv_palette_main(LV_PALETTE_BLUE), lv_palette_main(LV_PALETTE_AMBER), LV_GRAD_DIR_HOR);
-//    biggerDefLabel.setBGColor(lv_palette_lighten(LV_PALETTE_AMBER, 2));
-//    biggerDefLabel.setTextColor(lv_palette_lighten(LV_PALETTE_BROWN, 2));
-    pScreenSetup->addObject(&biggerDefLabel);
-
-    lvppBase::removeDefaultBGColor();
-
-    static lvppButton bigButton("def2");
-    bigButton.align(LV_ALIGN_CENTER, 0, 40);
-    bigButton.setText("Big Default");
-    bigButton.setColorGradient(lv_palette_main(LV_PALETTE_LIGHT_BLUE), lv_palette_main(LV_PALETTE_LIGHT_GREEN), LV_GRAD_DIR_HOR);
-    bigButton.setAdjText("Adjacent label", 0, 35);
-    bigButton.setAdjBGColor(lv_palette_lighten(LV_PALETTE_BLUE, 2));
-    pScreenSetup->addObject(&bigButton);
-
-    lvppBase::setDefaultBGColor(lv_palette_darken(LV_PALETTE_TEAL, 1));
-
-    static lvppBar bar1("defslider");
-    bar1.setSize(15, 100);
-    bar1.align(LV_ALIGN_BOTTOM_LEFT, 5, -5);
-    bar1.setColorGradient(lv_palette_main(LV_PALETTE_AMBER), lv_palette_main(LV_PALETTE_INDIGO), LV_GRAD_DIR_VER);
-    bar1.setValue(35);
-    pScreenSetup->addObject(&bar1);
-
-    static lvppButton exitSetupButton("ExitSetup", "Exit");
-    exitSetupButton.align(LV_ALIGN_BOTTOM_RIGHT, -3, -3);
-    exitSetupButton.setCallbackOnClicked([]() -> void {
+    UiLayout::bindCallback("exitSetup", []() -> void {
         // Time to load the main screen again.
-        pScreenMain->activateScreen(500, LV_SCR_LOAD_ANIM_OVER_RIGHT);
+        ScreenTransition::activate(pScreenMain, 500, LV_SCR_LOAD_ANIM_OVER_RIGHT);
     });
 
-    pScreenSetup->addObject(&exitSetupButton);
+    // Described in layouts/setup.json. The emulator maps the compiled .bin if there is one, so layout
+    // edits show up without a rebuild; otherwise (and always on the ESP32) the copy linked into flash is used.
+    setupScreenLayout.construct();
+    if (!setupScreenLayout->mapFile(UI_LAYOUT_DIR "/setup.bin"))
+        setupScreenLayout->load(setupLayout, sizeof(setupLayout));
 
+    pScreenSetup = &screenSetup.construct("setup screen", [](LazyScreen& screen) {
+        setupScreenLayout->build(screen);
+    });
 }
 
-
 ////////////////////////////////////////
 //
 //  M i s t i n g S t a t u s
@@ -206,42 +237,44 @@ void instantiateWidgets(void) {
 ////////////////////////////////////////
 
 TimeStatus::TimeStatus(void) : lvppButton("MistStatus", "Remaining:") {
-    setSize(150, 44);
+    HeapScope scope(getName());
+    setSize(TIME_STATUS_WIDTH, TIME_STATUS_HEIGHT);
     align(LV_ALIGN_CENTER, 0, -32);
 //    setFontSize(32);
 
-    setTextColor(lv_palette_darken(LV_PALETTE_GREEN, 4));
+    lv_color_t textColor = lv_palette_darken(LV_PALETTE_GREEN, 4);
+    setTextColor(textColor);
     lv_style_set_bg_color(&style_obj, lv_palette_lighten(LV_PALETTE_GREEN, 2));
     lv_style_set_border_color(&style_obj, lv_palette_darken(LV_PALETTE_GREEN, 3));
 //    lv_style_set_text_color(&style_obj, lv_palette_darken(LV_PALETTE_GREEN, 4));
     lv_obj_add_style(obj, &style_obj, 0);
 
-    lv_style_init(&style_shadow);
-    lv_style_set_text_opa(&style_shadow, LV_OPA_40);
-    lv_style_set_text_color(&style_shadow, lv_color_black());
-
-    shadow_label = lv_label_create(lv_scr_act());
-    lv_obj_add_style(shadow_label, &style_shadow, 0);
-
-    lv_label_set_text(shadow_label, lv_label_get_text(label));
-    lv_obj_align_to(shadow_label, label, LV_ALIGN_TOP_LEFT, 1, 1);
-
-    // Setup the main font and the shadow behind it.
-    lv_style_set_text_font(&style_obj, &lv_font_montserrat_24);
-    lv_obj_add_style(label, &style_obj, LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_style_set_text_font(&style_shadow, &lv_font_montserrat_24);
-    lv_obj_add_style(shadow_label, &style_shadow, LV_PART_MAIN | LV_STATE_DEFAULT);
+    // Text and its 40% black shadow are rasterized together into one bitmap, and only when the text
+    // changes. The button's own label stays hidden.
+    lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_update_layout(obj);
+    const lv_font_t* font = GlyphCache::wrap(&lv_font_montserrat_24);
+    assert(font->line_height <= TIME_STATUS_LINE_HEIGHT);
+    statusText.construct(obj, font, lv_obj_get_content_width(obj), statusBitmap, (uint32_t) sizeof(statusBitmap));
+    statusText->setTextColor(textColor);
+    statusText->setShadow(lv_color_black(), LV_OPA_40, 1, 1);
+    statusText->setText(lv_label_get_text(label));
 }
 
 TimeStatus::~TimeStatus() {
-
+    statusText->~ShadowLabel();
 }
 
 void TimeStatus::setText(const char* pText) {
-    if (pText) {
-        lv_label_set_text(label, pText);
-        lv_label_set_text(shadow_label, pText);
-    }
+    if (pText)
+        statusText->setText(pText);
+}
+
+void TimeStatus::format(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    statusText->vformat(fmt, args);
+    va_end(args);
 }
 
 ////////////////////////////////////////
@@ -251,11 +284,15 @@ void TimeStatus::setText(const char* pText) {
 ////////////////////////////////////////
 
 TempGauge::TempGauge() : lvppArc("Temp") {
+    HeapScope scope(getName());
     align(LV_ALIGN_BOTTOM_RIGHT, -47, -7);
     setSize(105, 105);
 
     // Temps ranging from 60 to 105
-    setRange(60, 105);
+    styled = false;
+    for (int16_t v = TEMP_GAUGE_MIN; v <= TEMP_GAUGE_MAX; v++)
+        colors[v - TEMP_GAUGE_MIN] = bandColor(v);
+    setRange(TEMP_GAUGE_MIN, TEMP_GAUGE_MAX);
     setArcRotationAndSweep(100, 0, 200);
 
     lv_obj_remove_style(obj, NULL, LV_PART_KNOB);
@@ -263,13 +300,12 @@ TempGauge::TempGauge() : lvppArc("Temp") {
 
     enableValueLabel(-20, -10);
 
-    setValueLabelFont(&lv_font_montserrat_32);
+    setValueLabelFont(GlyphCache::wrap(&lv_font_montserrat_32));
     setValueLabelFormat("%d F");
     setTemp(65);
 }
 
-void TempGauge::onValueChanged() {
-    curValue = lv_arc_get_value(obj);
+lv_color_t TempGauge::bandColor(int16_t value) {
     // hue range is 0-359
     // saturation and value are 0-100
     uint16_t h;
@@ -283,21 +319,36 @@ void TempGauge::onValueChanged() {
     // 200 - light blue
     // 220 - dark blue
 
-    if (curValue >= 95)
+    if (value >= 95)
         h = 5;
-    else if (curValue >= 80)
+    else if (value >= 80)
         h = 30;
-    else if (curValue >= 70)
+    else if (value >= 70)
         h = 50;
     else
         h = 200;
 
-    lv_color_t tempColor = lv_color_hsv_to_rgb(h, 100, 100);
+    return lv_color_hsv_to_rgb(h, 100, 100);
+}
+
+void TempGauge::onValueChanged() {
+    curValue = lv_arc_get_value(obj);
+    int16_t i = curValue < TEMP_GAUGE_MIN ? 0 : (curValue > TEMP_GAUGE_MAX ? TEMP_GAUGE_MAX : curValue) - TEMP_GAUGE_MIN;
+    lv_color_t tempColor = colors[i];
+
+    // Same band - arc and label already have the color.
+    if (styled && tempColor.full == shownColor.full)
+        return;
+    shownColor = tempColor;
+    styled = true;
 
     setValueLabelColor(tempColor);
     setArcColor(tempColor);
 }
 
 void TempGauge::setTemp(uint8_t tempValue) {
-    setValue(tempValue);
+    int16_t value = tempValue < TEMP_GAUGE_MIN ? TEMP_GAUGE_MIN : (tempValue > TEMP_GAUGE_MAX ? TEMP_GAUGE_MAX : tempValue);
+    if (styled && value == curValue)
+        return;
+    setValue(value);
 }
@@ -30,22 +30,52 @@
 #include "lvpp.h"
 #include <vector>
 #include "GlobalObjects.h"
+#include "ShadowLabel.h"
+#include "StaticWidgets.h"
+#include "HistoryChart.h"
 
 void instantiateWidgets(void);
 
+#define TIME_STATUS_WIDTH 150
+#define TIME_STATUS_HEIGHT 44
+// Line height the status text's bitmap is sized for - a little over Montserrat 24's (checked at boot).
+#define TIME_STATUS_LINE_HEIGHT 30
+
 class TimeStatus : public lvppButton {
 public:
     TimeStatus(void);
     virtual ~TimeStatus();
     void setText(const char* pText);
+    /**
+     * @brief printf-style setText() without a heap string. Unchanged text is a no-op.
+     */
+    void format(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
 protected:
-    lv_style_t style_shadow;
-    lv_obj_t* shadow_label;
+    // Built in place by the constructor, drawing into statusBitmap - no heap.
+    StaticSlot<ShadowLabel> statusText;
+    alignas(4) uint8_t statusBitmap[SHADOW_LABEL_BUF_SIZE(TIME_STATUS_WIDTH, TIME_STATUS_LINE_HEIGHT)];
 };
 
+#define TEMP_GAUGE_MIN 60
+#define TEMP_GAUGE_MAX 105
+
+// Time each pixel column of the temperature and water level history charts covers.
+#define HISTORY_COLUMN_MS 1000
+
 class TempGauge : public lvppArc {
 public:
     TempGauge(void);
     void onValueChanged();
+    /**
+     * @brief Shows tempValue (clamped to the gauge range). The same value again does nothing, and the arc
+     *        and label are only restyled when the color band changes.
+     */
     void setTemp(uint8_t tempValue);
+protected:
+    static lv_color_t bandColor(int16_t value);
+
+    // Color for every value in the range, computed once.
+    lv_color_t colors[TEMP_GAUGE_MAX - TEMP_GAUGE_MIN + 1];
+    lv_color_t shownColor;
+    bool styled;
 };
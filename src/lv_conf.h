@@ -60,10 +60,19 @@
 #endif
 
 #else       /*LV_MEM_CUSTOM*/
+#if POOL_ALLOCATOR || HEAP_SCOPES
+/*Through src/HeapScope.cpp: per-scope attribution (HEAP_SCOPES) on top of malloc or, with POOL_ALLOCATOR,
+ *pools + TLSF over a fixed arena (src/PoolAllocator.cpp, arena size POOL_ALLOC_ARENA_SIZE)*/
+#  define LV_MEM_CUSTOM_INCLUDE "HeapScope.h"
+#  define LV_MEM_CUSTOM_ALLOC   heapScopeAlloc
+#  define LV_MEM_CUSTOM_FREE    heapScopeFree
+#  define LV_MEM_CUSTOM_REALLOC heapScopeRealloc
+#else
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
 #  define LV_MEM_CUSTOM_ALLOC   malloc
 #  define LV_MEM_CUSTOM_FREE    free
 #  define LV_MEM_CUSTOM_REALLOC realloc
+#endif
 #endif     /*LV_MEM_CUSTOM*/
 
 /*Number of the intermediate memory buffer used during rendering and other internal processing mechanisms.
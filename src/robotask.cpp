@@ -26,6 +26,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 #include "robotask.h"
+#include "HeapScope.h"
 
 // #define _TASKDEBUG
 
@@ -230,6 +231,8 @@ void RoboTask::RoboPrivateStarterTask(void* vtask) {
 #ifndef ESP_PLATFORM
   task->this_thread_id = std::this_thread::get_id();
 #endif
+  // Everything this task allocates is charged to its name unless it opens a narrower HeapScope.
+  HeapScope::setThreadScope(task->taskName);
 
   while (task->running_) {
 
@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+#
+# Build-time Montserrat subsetting.
+#
+# LVGL compiles every enabled lv_font_montserrat_N with the full ASCII range plus ~60 symbols, while
+# this project only ever shows a few dozen distinct characters. This script scans src/ and layouts/ for the
+# text the firmware can actually display (string literals, format specifiers, LV_SYMBOL_* uses), runs lv_font_conv
+# for each enabled size, and adds the results to the build. The generated fonts define the very same
+# lv_font_montserrat_N symbols, so the linker takes them from the project objects and never pulls the
+# full fonts out of the LVGL archive - no LVGL or LVGLPlusPlus changes needed.
+#
+# Sizes referenced in src/ get the scanned character set. Sizes that are enabled but never referenced
+# are kept (libraries may still link against them) and shrunk to digits only.
+#
+# As a PlatformIO pre-script (see env:esp32dev), tuned by these optional project options:
+#   custom_font_subset_chars = <text>   use exactly these characters instead of scanning
+#   custom_font_subset_extra = <text>   add these characters to the scanned set (e.g. runtime-only text)
+#   custom_font_subset_sizes = 14, 22   treat these sizes as used even if the scan misses them
+#
+# Standalone, to see what would be generated without building anything:
+#   python3 support/font_subset.py [--extra "text"]
+#
+# Needs lv_font_conv (npm i -g lv_font_conv). Without it the build carries on with the full fonts.
+
+import hashlib
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+FONT_TTF = "Montserrat-Medium.ttf"
+SYMBOL_FONT = "FontAwesome5-Solid+Brands+Regular.woff"
+
+# Always present: digits for values, and the symbols LVGL's own widgets draw (dropdown arrows, checkbox).
+BASE_CHARS = " 0123456789-.%"
+BASE_SYMBOLS = ["DOWN", "UP", "LEFT", "RIGHT", "OK"]
+UNUSED_SIZE_CHARS = " 0123456789"
+
+FORMAT_SPEC = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?([diouxXfFeEgGcs%])")
+FORMAT_CHARS = {
+    "d": "0123456789-", "i": "0123456789-", "u": "0123456789", "o": "01234567",
+    "x": "0123456789abcdef", "X": "0123456789ABCDEF",
+    "f": "0123456789-.", "F": "0123456789-.", "e": "0123456789-.e+", "E": "0123456789-.E+",
+    "g": "0123456789-.e+", "G": "0123456789-.E+", "%": "%",
+}
+
+STRING_LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+SYMBOL_USE = re.compile(r"\bLV_SYMBOL_(\w+)")
+FONT_USE = re.compile(r"\blv_font_montserrat_(\d+)\b")
+# Widget sizes set in code: lvpp setFontSize(N) and the WidgetDef builder's .font(N) (see src/Widgets.cpp).
+FONT_SIZE_USE = re.compile(r"\b(?:setFontSize|font)\s*\(\s*(\d+)\s*\)")
+# Size -> font lookup tables name every enabled size without using any of them; the sizes they hand out
+# come from the layouts (scan_layouts) and the widget definitions instead.
+FONT_TABLES = ("UiLayout.cpp",)
+FONT_ENABLED = re.compile(r"LV_FONT_MONTSERRAT_(\d+)\s*=?\s*1\b")
+
+# Lines whose strings never reach the display.
+NOT_DISPLAYED = re.compile(r"\b(?:f?printf|s?n?printf(?:_P)?|LV_LOG\w*|log_\w)\s*\(|#\s*include|#\s*error")
+
+
+def strip_comments(text):
+    text = re.sub(r"/\*.*?\*/", lambda m: "\n" * m.group(0).count("\n"), text, flags=re.S)
+    return re.sub(r"//[^\n]*", "", text)
+
+
+def unescape(literal):
+    """C string literal body -> bytes."""
+    out = bytearray()
+    i = 0
+    simple = {"n": 10, "t": 9, "r": 13, "0": 0, "\\": 92, '"': 34, "'": 39}
+    while i < len(literal):
+        c = literal[i]
+        if c == "\\" and i + 1 < len(literal):
+            n = literal[i + 1]
+            if n == "x":
+                m = re.match(r"[0-9A-Fa-f]{1,2}", literal[i + 2:])
+                out.append(int(m.group(0), 16))
+                i += 2 + len(m.group(0))
+                continue
+            out.append(simple.get(n, ord(n)))
+            i += 2
+            continue
+        out.extend(c.encode("utf-8"))
+        i += 1
+    return bytes(out)
+
+
+def load_symbols(lvgl_dir):
+    """LV_SYMBOL_xxx -> code point, parsed from LVGL's lv_symbol_def.h."""
+    symbols = {}
+    path = os.path.join(lvgl_dir or "", "src", "font", "lv_symbol_def.h")
+    if not os.path.isfile(path):
+        return symbols
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for name, value in re.findall(r'#define\s+LV_SYMBOL_(\w+)\s+"((?:\\x[0-9A-Fa-f]{2})+)"', f.read()):
+            text = unescape(value).decode("utf-8", errors="ignore")
+            if len(text) == 1:
+                symbols[name] = ord(text)
+    return symbols
+
+
+def scan_sources(src_dirs):
+    """Returns (chars, symbol names, sizes referenced, notes)."""
+    chars, symbols, sizes, notes = set(BASE_CHARS), set(BASE_SYMBOLS), set(), []
+    for src_dir in src_dirs:
+        for root, _, files in os.walk(src_dir):
+            for name in sorted(files):
+                if not name.endswith((".c", ".cpp", ".h", ".hpp")) or name == "lv_conf.h":
+                    continue
+                path = os.path.join(root, name)
+                with open(path, encoding="utf-8", errors="replace") as f:
+                    text = strip_comments(f.read())
+                if name not in FONT_TABLES:
+                    sizes.update(int(s) for s in FONT_USE.findall(text))
+                sizes.update(int(s) for s in FONT_SIZE_USE.findall(text))
+                for lineno, line in enumerate(text.splitlines(), 1):
+                    symbols.update(SYMBOL_USE.findall(line))
+                    if NOT_DISPLAYED.search(line):
+                        continue
+                    for literal in STRING_LITERAL.findall(line):
+                        body = unescape(literal).decode("utf-8", errors="ignore")
+                        for spec in FORMAT_SPEC.finditer(body):
+                            conv = spec.group(1)
+                            if conv in "sc":
+                                notes.append("%s:%d: '%%%s' text is only known at run time"
+                                             % (os.path.relpath(path), lineno, conv))
+                            chars.update(FORMAT_CHARS.get(conv, ""))
+                        chars.update(c for c in FORMAT_SPEC.sub("", body) if c.isprintable())
+                    if "to_string" in line:
+                        chars.update("0123456789-.")
+    return chars, symbols, sizes, notes
+
+
+LAYOUT_TEXT_KEYS = ("text", "set_text", "adj_text", "options", "options_with_id", "value_label_format")
+LAYOUT_SYMBOL = re.compile(r"\{([A-Z_]+)\}")
+
+
+def scan_layouts(layout_dir, chars, symbols, sizes):
+    """Adds the text and font sizes of the screen layouts (see support/layout_compiler.py)."""
+    if not os.path.isdir(layout_dir):
+        return
+
+    def add_text(value):
+        if isinstance(value, list):
+            for v in value:
+                add_text(v)
+        elif isinstance(value, str):
+            symbols.update(LAYOUT_SYMBOL.findall(value))
+            body = LAYOUT_SYMBOL.sub("", value)
+            for spec in FORMAT_SPEC.finditer(body):
+                chars.update(FORMAT_CHARS.get(spec.group(1), ""))
+            chars.update(c for c in FORMAT_SPEC.sub("", body) if c.isprintable())
+
+    for name in sorted(os.listdir(layout_dir)):
+        if not name.endswith(".json"):
+            continue
+        with open(os.path.join(layout_dir, name), encoding="utf-8") as f:
+            layout = json.load(f)
+        for w in layout.get("widgets", []):
+            props = w.get("defaults", w)
+            if "font_size" in props:
+                sizes.add(int(props["font_size"]))
+            for key in LAYOUT_TEXT_KEYS:
+                add_text(props.get(key))
+
+
+def font_data_bytes(c_file):
+    """Rough flash footprint of an lv_font_conv C file: bitmap, glyph descriptors and kerning tables."""
+    if not os.path.isfile(c_file):
+        return 0
+    with open(c_file, encoding="utf-8", errors="replace") as f:
+        text = strip_comments(f.read())
+    total = 0
+    m = re.search(r"glyph_bitmap\[\]\s*=\s*\{(.*?)\};", text, re.S)
+    if m:
+        total += len(re.findall(r"0x[0-9a-fA-F]+", m.group(1)))
+    m = re.search(r"glyph_dsc\[\]\s*=\s*\{(.*?)\};", text, re.S)
+    if m:
+        total += 8 * m.group(1).count("{")
+    for table in re.findall(r"kern_\w+\[\]\s*=\s*\{(.*?)\};", text, re.S):
+        total += len(re.findall(r"-?\b(?:0x)?[0-9a-fA-F]+\b", table))
+    return total
+
+
+def build_codepoints(chars, symbols, symbol_map):
+    text = "".join(sorted(c for c in chars if ord(c) < 0xF000))
+    cps = sorted(symbol_map[s] for s in symbols if s in symbol_map)
+    return text, cps
+
+
+def generate(out_dir, lvgl_dir, sizes_enabled, sizes_used, chars, symbols, symbol_map, converter):
+    """Runs lv_font_conv for every enabled size. Returns [(size, full bytes, subset bytes)]."""
+    font_dir = os.path.join(lvgl_dir, "scripts", "built_in_font")
+    text, cps = build_codepoints(chars, symbols, symbol_map)
+    stamp = hashlib.sha1(repr((sorted(sizes_enabled), sorted(sizes_used), text, cps)).encode()).hexdigest()
+    stamp_file = os.path.join(out_dir, "stamp")
+    fresh = os.path.isfile(stamp_file) and open(stamp_file).read() == stamp
+
+    os.makedirs(out_dir, exist_ok=True)
+    report = []
+    for size in sorted(sizes_enabled):
+        name = "lv_font_montserrat_%d" % size
+        out = os.path.join(out_dir, name + ".c")
+        if not fresh:
+            cmd = converter + ["--bpp", "4", "--size", str(size), "--no-compress", "--format", "lvgl",
+                               "--lv-font-name", name, "--force-fast-kern-format", "-o", out,
+                               "--font", os.path.join(font_dir, FONT_TTF)]
+            if size in sizes_used:
+                cmd += ["--symbols", text]
+                if cps:
+                    cmd += ["--font", os.path.join(font_dir, SYMBOL_FONT), "-r", ",".join(str(c) for c in cps)]
+            else:
+                cmd += ["--symbols", UNUSED_SIZE_CHARS]
+            subprocess.check_call(cmd, stdout=subprocess.DEVNULL)
+        report.append((size, font_data_bytes(os.path.join(lvgl_dir, "src", "font", name + ".c")),
+                       font_data_bytes(out)))
+
+    with open(stamp_file, "w") as f:
+        f.write(stamp)
+    return report
+
+
+def print_report(report):
+    full = sum(r[1] for r in report)
+    subset = sum(r[2] for r in report)
+    print("Font subset:  size      full    subset")
+    for size, f, s in report:
+        print("              %4d  %8d  %8d" % (size, f, s))
+    print("Font subset: ~%d bytes of flash saved (%d -> %d). RAM unchanged - fonts are const data."
+          % (full - subset, full, subset))
+
+
+def enabled_sizes(flags, lv_conf):
+    sizes = set(int(s) for s in FONT_ENABLED.findall(" ".join(flags)))
+    if lv_conf and os.path.isfile(lv_conf):
+        with open(lv_conf, encoding="utf-8", errors="replace") as f:
+            sizes.update(int(s) for s in re.findall(r"#define\s+LV_FONT_MONTSERRAT_(\d+)\s+1\b", f.read()))
+    return sizes
+
+
+def parse_sizes(text):
+    return set(int(s) for s in re.findall(r"\d+", text or ""))
+
+
+def run_platformio(env):
+    project_dir = env.subst("$PROJECT_DIR")
+    src_dir = env.subst("$PROJECT_SRC_DIR")
+    lvgl_dir = os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"), "lvgl")
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "font_subset")
+
+    converter = shutil.which("lv_font_conv")
+    if not converter:
+        print("Font subset: lv_font_conv not found (npm i -g lv_font_conv) - building with full fonts.")
+        return
+    if not os.path.isdir(os.path.join(lvgl_dir, "scripts", "built_in_font")):
+        print("Font subset: LVGL font sources not found in %s - building with full fonts." % lvgl_dir)
+        return
+
+    explicit = env.GetProjectOption("custom_font_subset_chars", "")
+    extra = env.GetProjectOption("custom_font_subset_extra", "")
+    chars, symbols, sizes_used, notes = scan_sources([src_dir])
+    scan_layouts(os.path.join(project_dir, "layouts"), chars, symbols, sizes_used)
+    if explicit:
+        chars = set(explicit) | set(UNUSED_SIZE_CHARS)
+    chars.update(extra)
+    sizes_used.update(parse_sizes(env.GetProjectOption("custom_font_subset_sizes", "")))
+    sizes_used.add(14)   # LV_FONT_DEFAULT, used by the theme
+
+    sizes_enabled = enabled_sizes(env.get("BUILD_FLAGS", []), os.path.join(project_dir, "src", "lv_conf.h"))
+    for note in notes:
+        print("Font subset: " + note + " - add its characters with custom_font_subset_extra")
+
+    try:
+        report = generate(out_dir, lvgl_dir, sizes_enabled, sizes_used, chars, symbols,
+                          load_symbols(lvgl_dir), [converter])
+    except (OSError, subprocess.CalledProcessError) as e:
+        print("Font subset: lv_font_conv failed (%s) - building with full fonts." % e)
+        return
+
+    print_report(report)
+    env.BuildSources(os.path.join("$BUILD_DIR", "font_subset_obj"), out_dir)
+
+
+def run_standalone(argv):
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    extra = argv[argv.index("--extra") + 1] if "--extra" in argv else ""
+    chars, symbols, sizes_used, notes = scan_sources([os.path.join(project_dir, "src")])
+    scan_layouts(os.path.join(project_dir, "layouts"), chars, symbols, sizes_used)
+    chars.update(extra)
+    sizes_used.add(14)
+
+    print("Sizes used:    %s" % ", ".join(str(s) for s in sorted(sizes_used)))
+    print("Characters:    %d  %s" % (len(chars), "".join(sorted(chars))))
+    print("Symbols:       %s" % ", ".join(sorted(symbols)))
+    for note in notes:
+        print("Note: " + note)
+
+
+try:
+    Import("env")   # noqa: F821 - provided by SCons when run as a PlatformIO extra script
+except NameError:
+    if __name__ == "__main__":
+        run_standalone(sys.argv[1:])
+else:
+    run_platformio(env)   # noqa: F821
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+#
+# Compiles a declarative screen layout (layouts/*.json) into the binary format read by src/UiLayout.cpp.
+#
+#   python3 support/layout_compiler.py layouts/setup.json
+#
+# writes layouts/setup.bin (for UiLayout::mapFile - the emulator picks it up without a rebuild) and
+# src/SetupLayout.h (the same bytes as a const array - on the ESP32 that is flash, mapped, never copied).
+#
+# Format, little endian, every table 4-byte aligned:
+#   header   magic "LVPL", u16 version, u16 widgetCount, u32 propOffset, u16 propCount,
+#            u16 stringCount, u32 stringOffset, u32 totalSize                                   (24 bytes)
+#   widgets  u8 type, u8 reserved, u16 name, u16 text, u16 propCount                           (8 bytes each)
+#   props    u8 op, u8 reserved, u16 a, i32 b, i32 c - each widget's props follow the previous  (12 bytes each)
+#   strings  u32 offset per string (from the start), then the NUL terminated strings
+#
+# Colors are "#RRGGBB", "white", "black", or an LVGL palette: "GREEN", "GREEN+2" (lighten 2), "TEAL-1" (darken 1).
+# Callbacks, styles and images are names; the loader matches them against UiLayout::bind*() by FNV-1a hash.
+# Keep the enums below in step with UiLayout.h.
+
+import json
+import os
+import re
+import struct
+import sys
+
+VERSION = 1
+NO_STRING = 0xFFFF
+
+WIDGET_TYPES = {"defaults": 0, "label": 1, "button": 2, "bar": 3, "switch": 4, "dropdown": 5,
+                "cyclebutton": 6, "arc": 7, "image": 8}
+
+OPS = {
+    "align": 1, "size": 2, "text": 3, "font_size": 4, "bg_color": 5, "text_color": 6, "gradient": 7,
+    "range": 8, "value": 9, "options": 10, "option": 11, "adj_text": 12, "adj_bg_color": 13,
+    "value_label": 14, "value_label_format": 15, "on_clicked": 16, "on_value_changed": 17, "style": 18,
+    "checked": 19, "dropdown_dir": 20, "image": 21, "rotation": 22,
+    # "defaults" pseudo widget only
+    "default_font_size": 40, "default_bg_color": 41, "default_text_color": 42, "remove_default_bg_color": 43,
+}
+
+# LVGL 8 enum values
+ALIGN = {"DEFAULT": 0, "TOP_LEFT": 1, "TOP_MID": 2, "TOP_RIGHT": 3, "BOTTOM_LEFT": 4, "BOTTOM_MID": 5,
+         "BOTTOM_RIGHT": 6, "LEFT_MID": 7, "RIGHT_MID": 8, "CENTER": 9}
+GRAD_DIR = {"NONE": 0, "VER": 1, "HOR": 2}
+DIR = {"LEFT": 1, "RIGHT": 2, "TOP": 4, "BOTTOM": 8}
+PALETTE = ["RED", "PINK", "PURPLE", "DEEP_PURPLE", "INDIGO", "BLUE", "LIGHT_BLUE", "CYAN", "TEAL", "GREEN",
+           "LIGHT_GREEN", "LIME", "YELLOW", "AMBER", "ORANGE", "DEEP_ORANGE", "BROWN", "BLUE_GREY", "GREY"]
+
+# LV_SYMBOL_xxx names usable as "{SETTINGS}" inside text
+SYMBOLS = {"POWER": "\uF011", "SHUFFLE": "\uF074", "REFRESH": "\uF021", "SETTINGS": "\uF013", "OK": "\uF00C",
+           "CLOSE": "\uF00D", "HOME": "\uF015", "LEFT": "\uF053", "RIGHT": "\uF054", "UP": "\uF077",
+           "DOWN": "\uF078", "PLUS": "\uF067", "MINUS": "\uF068", "SAVE": "\uF0C7", "EDIT": "\uF304"}
+
+
+class LayoutError(Exception):
+    pass
+
+
+def fnv1a(name):
+    h = 0x811C9DC5
+    for b in name.encode("utf-8"):
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def signed(v):
+    return v - (1 << 32) if v >= (1 << 31) else v
+
+
+def color(value):
+    """Literal colors are 0x00RRGGBB, palette colors 0x01 | palette << 16 | mode << 8 | level."""
+    v = value.strip()
+    if v.lower() == "white":
+        return 0xFFFFFF
+    if v.lower() == "black":
+        return 0x000000
+    if v.startswith("#") and len(v) == 7:
+        return int(v[1:], 16)
+    m = re.fullmatch(r"([A-Z_]+)(?:([+-])(\d))?", v)
+    if not m or m.group(1) not in PALETTE:
+        raise LayoutError("bad color '%s'" % value)
+    mode = 0 if not m.group(2) else (1 if m.group(2) == "+" else 2)
+    level = int(m.group(3) or 0)
+    return (0x01 << 24) | (PALETTE.index(m.group(1)) << 16) | (mode << 8) | level
+
+
+def lookup(table, value, what):
+    if value not in table:
+        raise LayoutError("unknown %s '%s' (one of %s)" % (what, value, ", ".join(table)))
+    return table[value]
+
+
+class Compiler:
+    def __init__(self):
+        self.strings = []
+        self.index = {}
+        self.widgets = []
+        self.props = []
+
+    def string(self, text):
+        text = re.sub(r"\{([A-Z_]+)\}", lambda m: lookup(SYMBOLS, m.group(1), "symbol"), text)
+        if text not in self.index:
+            self.index[text] = len(self.strings)
+            self.strings.append(text)
+        return self.index[text]
+
+    def prop(self, op, a=0, b=0, c=0):
+        self.props.append((OPS[op], a, signed(b & 0xFFFFFFFF), signed(c & 0xFFFFFFFF)))
+
+    def widget(self, w):
+        if "defaults" in w:
+            first = len(self.props)
+            d = w["defaults"]
+            if d.get("remove_bg_color"):
+                self.prop("remove_default_bg_color")
+            if "font_size" in d:
+                self.prop("default_font_size", d["font_size"])
+            if "bg_color" in d:
+                self.prop("default_bg_color", 0, color(d["bg_color"]))
+            if "text_color" in d:
+                self.prop("default_text_color", 0, color(d["text_color"]))
+            self.widgets.append((WIDGET_TYPES["defaults"], NO_STRING, NO_STRING, len(self.props) - first))
+            return
+
+        kind = lookup(WIDGET_TYPES, w.get("type"), "widget type")
+        if "name" not in w:
+            raise LayoutError("widget without a name: %s" % w)
+        name = self.string(w["name"])
+        text = self.string(w["text"]) if "text" in w else NO_STRING
+        first = len(self.props)
+
+        if "align" in w:
+            a = w["align"]
+            self.prop("align", lookup(ALIGN, a[0], "alignment"), a[1] if len(a) > 1 else 0, a[2] if len(a) > 2 else 0)
+        if "size" in w:
+            self.prop("size", 0, w["size"][0], w["size"][1])
+        if "set_text" in w:
+            self.prop("text", self.string(w["set_text"]))
+        if "font_size" in w:
+            self.prop("font_size", w["font_size"])
+        if "bg_color" in w:
+            self.prop("bg_color", 0, color(w["bg_color"]))
+        if "text_color" in w:
+            self.prop("text_color", 0, color(w["text_color"]))
+        if "gradient" in w:
+            g = w["gradient"]
+            self.prop("gradient", lookup(GRAD_DIR, g[2], "gradient direction"), color(g[0]), color(g[1]))
+        if "range" in w:
+            self.prop("range", 0, w["range"][0], w["range"][1])
+        if "options" in w:
+            self.prop("options", self.string("\n".join(w["options"])))
+        for text_, id_ in w.get("options_with_id", []):
+            self.prop("option", self.string(text_), id_)
+        if "dropdown_dir" in w:
+            self.prop("dropdown_dir", lookup(DIR, w["dropdown_dir"], "direction"))
+        if "value_label_format" in w:
+            self.prop("value_label_format", self.string(w["value_label_format"]))
+        if "value_label" in w:
+            v = w["value_label"]
+            self.prop("value_label", lookup(ALIGN, v[2] if len(v) > 2 else "CENTER", "alignment"), v[0], v[1])
+        if "image" in w:
+            self.prop("image", 0, fnv1a(w["image"]))
+        if "rotation" in w:
+            self.prop("rotation", 0, w["rotation"])
+        if "value" in w:
+            self.prop("value", 0, w["value"])
+        if "checked" in w:
+            self.prop("checked", 1 if w["checked"] else 0)
+        if "adj_text" in w:
+            t = w["adj_text"]
+            self.prop("adj_text", self.string(t[0]), t[1] if len(t) > 1 else 0, t[2] if len(t) > 2 else 0)
+        if "adj_bg_color" in w:
+            self.prop("adj_bg_color", 0, color(w["adj_bg_color"]))
+        for style in w.get("styles", []):
+            self.prop("style", 0, fnv1a(style))
+        if "on_clicked" in w:
+            self.prop("on_clicked", 0, fnv1a(w["on_clicked"]))
+        if "on_value_changed" in w:
+            self.prop("on_value_changed", 0, fnv1a(w["on_value_changed"]))
+
+        self.widgets.append((kind, name, text, len(self.props) - first))
+
+    def binary(self):
+        header_size = 24
+        widget_off = header_size
+        prop_off = widget_off + 8 * len(self.widgets)
+        string_off = prop_off + 12 * len(self.props)
+
+        blobs = [s.encode("utf-8") + b"\0" for s in self.strings]
+        offsets, pos = [], string_off + 4 * len(blobs)
+        for b in blobs:
+            offsets.append(pos)
+            pos += len(b)
+        total = (pos + 3) & ~3
+
+        out = bytearray()
+        out += struct.pack("<4sHHIHHII", b"LVPL", VERSION, len(self.widgets), prop_off,
+                           len(self.props), len(self.strings), string_off, total)
+        for kind, name, text, count in self.widgets:
+            out += struct.pack("<BBHHH", kind, 0, name, text, count)
+        for op, a, b, c in self.props:
+            out += struct.pack("<BBHii", op, 0, a, b, c)
+        for o in offsets:
+            out += struct.pack("<I", o)
+        for b in blobs:
+            out += b
+        out += b"\0" * (total - len(out))
+        return bytes(out)
+
+
+def c_header(data, array, source):
+    lines = ["// Generated by support/layout_compiler.py from %s - do not edit." % source,
+             "#pragma once", "", "#include <cstdint>", "",
+             "alignas(4) static const uint8_t %s[%d] = {" % (array, len(data))]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    lines += ["};", ""]
+    return "\n".join(lines)
+
+
+def main(argv):
+    if len(argv) != 1:
+        print("usage: layout_compiler.py layouts/<name>.json")
+        return 2
+    src = argv[0]
+    project = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    with open(src, encoding="utf-8") as f:
+        layout = json.load(f)
+
+    compiler = Compiler()
+    try:
+        for w in layout["widgets"]:
+            compiler.widget(w)
+    except (LayoutError, KeyError, IndexError, TypeError) as e:
+        print("%s: %s" % (src, e))
+        return 1
+    data = compiler.binary()
+
+    base = os.path.splitext(src)[0]
+    with open(base + ".bin", "wb") as f:
+        f.write(data)
+
+    name = layout.get("name", os.path.basename(base))
+    camel = name[0].upper() + name[1:]
+    header = os.path.join(project, "src", camel + "Layout.h")
+    with open(header, "w") as f:
+        f.write(c_header(data, name + "Layout", os.path.relpath(os.path.abspath(src), project)))
+
+    print("%s: %d widgets, %d properties, %d strings, %d bytes -> %s.bin, %s"
+          % (src, len(compiler.widgets), len(compiler.props), len(compiler.strings), len(data),
+             base, os.path.relpath(header, project)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))